@@ -0,0 +1,114 @@
+#pragma once
+
+#include "dijkstra_router.h"
+#include "graph.h"
+
+#include <algorithm>
+#include <chrono>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Limits of one alternative routes query, zero means no limit
+struct SearchBudget {
+    size_t max_searches = 0;
+    std::chrono::milliseconds max_duration{0};
+};
+
+// Up to `count` loopless routes from `from` to `to` in order of weight (Yen's algorithm). Spur
+// searches run on the Dijkstra router with the edges they may not take blocked by a filter,
+// the graph itself is never copied or changed. Once the budget runs out the routes ranked so
+// far are returned.
+template <typename Weight>
+std::vector<RouteInfo<Weight>> BuildAlternativeRoutes(const DirectedWeightedGraph<Weight>& graph,
+                                                      const DijkstraRouter<Weight>& router,
+                                                      VertexId from, VertexId to, size_t count,
+                                                      const SearchBudget& budget) {
+    std::vector<RouteInfo<Weight>> routes;
+    if (count == 0) {
+        return routes;
+    }
+    if (auto route = router.BuildRoute(from, to)) {
+        routes.push_back(std::move(*route));
+    }
+    else {
+        return routes;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    size_t search_count = 0;
+    auto has_budget = [&]() {
+        return (budget.max_searches == 0 || search_count < budget.max_searches)
+            && (budget.max_duration.count() == 0 || std::chrono::steady_clock::now() - start < budget.max_duration);
+    };
+
+    // Weight first, the edges tell equal weights apart and drop duplicates
+    std::set<std::pair<Weight, std::vector<EdgeId>>> candidates;
+    std::set<std::vector<EdgeId>> found{routes.front().edges};
+    std::vector<bool> is_root_vertex(graph.GetVertexCount(), false);
+    std::vector<bool> is_blocked_edge(graph.GetEdgeCount(), false);
+
+    while (routes.size() < count) {
+        const std::vector<EdgeId> previous = routes.back().edges;
+        VertexId spur_vertex = from;
+        size_t spur_index = 0;
+
+        for (; spur_index < previous.size() && has_budget(); ++spur_index) {
+            // Found routes sharing the root may not leave the spur vertex the same way again
+            std::vector<EdgeId> blocked_edges;
+            for (const auto& route : routes) {
+                if (route.edges.size() > spur_index
+                    && std::equal(previous.begin(), previous.begin() + spur_index, route.edges.begin())) {
+                    blocked_edges.push_back(route.edges[spur_index]);
+                    is_blocked_edge[route.edges[spur_index]] = true;
+                }
+            }
+
+            ++search_count;
+            const auto spur = router.BuildRouteAvoiding(spur_vertex, to, [&](EdgeId edge_id) {
+                return is_blocked_edge[edge_id] || is_root_vertex[graph.GetEdge(edge_id).to];
+            });
+            for (const EdgeId edge_id : blocked_edges) {
+                is_blocked_edge[edge_id] = false;
+            }
+
+            if (spur) {
+                std::vector<EdgeId> edges(previous.begin(), previous.begin() + spur_index);
+                edges.insert(edges.end(), spur->edges.begin(), spur->edges.end());
+                // Summed from the start, so that a route found from several spurs gets one weight
+                Weight weight{};
+                for (const EdgeId edge_id : edges) {
+                    weight += graph.GetEdge(edge_id).weight;
+                }
+                if (!found.count(edges)) {
+                    candidates.emplace(weight, std::move(edges));
+                }
+            }
+
+            const auto& edge = graph.GetEdge(previous[spur_index]);
+            is_root_vertex[spur_vertex] = true;
+            spur_vertex = edge.to;
+        }
+
+        is_root_vertex[from] = false;
+        for (const EdgeId edge_id : previous) {
+            is_root_vertex[graph.GetEdge(edge_id).to] = false;
+        }
+
+        // Without every spur of the last route the best candidate may not be the next one
+        if (spur_index < previous.size() || candidates.empty()) {
+            break;
+        }
+
+        RouteInfo<Weight> route{candidates.begin()->first, candidates.begin()->second};
+        candidates.erase(candidates.begin());
+        found.insert(route.edges);
+        routes.push_back(std::move(route));
+    }
+
+    return routes;
+}
+
+}  // namespace graph
@@ -0,0 +1,580 @@
+#pragma once
+
+#include "graph.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Edge added during contraction. It replaces the path first_edge -> second_edge,
+// where both ids may refer either to graph edges or to other shortcuts.
+template <typename Weight>
+struct Shortcut {
+    VertexId from;
+    VertexId to;
+    Weight weight;
+    EdgeId first_edge;
+    EdgeId second_edge;
+};
+
+// Result of the preprocessing stage, detached from the graph so it can be stored in the base.
+// Shortcut number i has id edge_count + i.
+template <typename Weight>
+struct ContractionHierarchyData {
+    size_t vertex_count = 0;
+    size_t edge_count = 0;
+    std::vector<size_t> ranks;
+    std::vector<Shortcut<Weight>> shortcuts;
+};
+
+// Point-to-point router over a contraction hierarchy. Vertices are contracted one by one
+// in order of importance, and shortcuts keep distances between the remaining vertices intact.
+// A query is a bidirectional Dijkstra that only follows edges leading to higher-ranked vertices.
+template <typename Weight>
+class ContractionHierarchy {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = graph::RouteInfo<Weight>;
+    using Data = ContractionHierarchyData<Weight>;
+
+    explicit ContractionHierarchy(const Graph& graph);
+    ContractionHierarchy(const Graph& graph, Data data);
+
+    static bool IsCompatible(const Graph& graph, const Data& data);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+
+    // Many-to-many weights with buckets: the backward search space of every target is stored at
+    // the vertices it settles, then the forward search of every source scans those buckets
+    std::vector<std::vector<std::optional<Weight>>> BuildWeightMatrix(const std::vector<VertexId>& sources,
+                                                                      const std::vector<VertexId>& targets) const;
+
+    const Data& GetData() const;
+
+private:
+    struct QueueItem {
+        Weight weight;
+        VertexId vertex;
+
+        bool operator>(const QueueItem& other) const {
+            return weight > other.weight;
+        }
+    };
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+    using AdjacencyLists = std::vector<std::vector<EdgeId>>;
+
+    struct SearchSpace {
+        explicit SearchSpace(size_t vertex_count)
+            : weights(vertex_count)
+            , prev_edges(vertex_count) {
+        }
+
+        std::vector<std::optional<Weight>> weights;
+        std::vector<std::optional<EdgeId>> prev_edges;
+        Queue queue;
+    };
+
+    // Mutable overlay graph used while vertices are being contracted
+    struct ContractionState {
+        explicit ContractionState(size_t vertex_count)
+            : out_edges(vertex_count)
+            , in_edges(vertex_count)
+            , contracted(vertex_count, false)
+            , deleted_neighbors(vertex_count, 0)
+            , witness_weights(vertex_count) {
+        }
+
+        AdjacencyLists out_edges;
+        AdjacencyLists in_edges;
+        std::vector<bool> contracted;
+        std::vector<int64_t> deleted_neighbors;
+
+        std::vector<std::optional<Weight>> witness_weights;
+        std::vector<VertexId> witness_touched;
+    };
+
+    static constexpr size_t WITNESS_SETTLE_LIMIT = 50;
+
+    Edge<Weight> GetHierarchyEdge(EdgeId edge_id) const;
+
+    void Contract();
+    int64_t ContractVertex(ContractionState& state, VertexId vertex, bool simulate);
+    int64_t GetPriority(ContractionState& state, VertexId vertex);
+    void CompactNeighborEdges(ContractionState& state, VertexId vertex) const;
+    std::vector<std::pair<VertexId, EdgeId>> GetCheapestNeighborEdges(const ContractionState& state,
+                                                                      VertexId vertex, bool outgoing) const;
+    void RunWitnessSearch(ContractionState& state, VertexId source, VertexId excluded, Weight max_weight) const;
+
+    void BuildSearchGraph();
+    void Step(SearchSpace& current, const SearchSpace& opposite, const AdjacencyLists& adjacency, bool forward,
+              std::optional<Weight>& best_weight, VertexId& meeting_vertex) const;
+    void UnpackEdge(EdgeId edge_id, std::vector<EdgeId>& edges) const;
+
+    // Exhausts the upward (forward) or downward (backward) search space of start, calling
+    // visit(vertex, weight) for every settled vertex. Labels are reset afterwards for reuse.
+    template <typename Visitor>
+    void ExploreSearchSpace(SearchSpace& space, VertexId start, bool forward, Visitor visit) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+    Data data_;
+    AdjacencyLists upward_edges_;
+    AdjacencyLists downward_edges_;
+};
+
+template <typename Weight>
+ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph)
+    : graph_(graph)
+{
+    data_.vertex_count = graph.GetVertexCount();
+    data_.edge_count = graph.GetEdgeCount();
+    data_.ranks.assign(data_.vertex_count, 0);
+
+    for (EdgeId edge_id = 0; edge_id < data_.edge_count; ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+
+    Contract();
+    BuildSearchGraph();
+}
+
+template <typename Weight>
+ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph, Data data)
+    : graph_(graph)
+    , data_(std::move(data))
+{
+    if (!IsCompatible(graph, data_)) {
+        throw std::invalid_argument("Contraction hierarchy does not match the graph");
+    }
+
+    BuildSearchGraph();
+}
+
+template <typename Weight>
+bool ContractionHierarchy<Weight>::IsCompatible(const Graph& graph, const Data& data) {
+    return data.vertex_count == graph.GetVertexCount()
+        && data.edge_count == graph.GetEdgeCount()
+        && data.ranks.size() == data.vertex_count;
+}
+
+template <typename Weight>
+const typename ContractionHierarchy<Weight>::Data& ContractionHierarchy<Weight>::GetData() const {
+    return data_;
+}
+
+template <typename Weight>
+Edge<Weight> ContractionHierarchy<Weight>::GetHierarchyEdge(EdgeId edge_id) const {
+    if (edge_id < data_.edge_count) {
+        return graph_.GetEdge(edge_id);
+    }
+
+    const auto& shortcut = data_.shortcuts.at(edge_id - data_.edge_count);
+    return Edge<Weight>{shortcut.from, shortcut.to, shortcut.weight};
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::Contract() {
+    ContractionState state(data_.vertex_count);
+    for (EdgeId edge_id = 0; edge_id < data_.edge_count; ++edge_id) {
+        const auto& edge = graph_.GetEdge(edge_id);
+        state.out_edges[edge.from].push_back(edge_id);
+        state.in_edges[edge.to].push_back(edge_id);
+    }
+    for (VertexId vertex = 0; vertex < data_.vertex_count; ++vertex) {
+        CompactNeighborEdges(state, vertex);
+    }
+
+    using PriorityItem = std::pair<int64_t, VertexId>;
+    std::priority_queue<PriorityItem, std::vector<PriorityItem>, std::greater<PriorityItem>> queue;
+    for (VertexId vertex = 0; vertex < data_.vertex_count; ++vertex) {
+        queue.push({GetPriority(state, vertex), vertex});
+    }
+
+    size_t rank = 0;
+    while (!queue.empty()) {
+        const VertexId vertex = queue.top().second;
+        queue.pop();
+
+        // Priorities go stale as neighbours get contracted, so re-check lazily before committing
+        const int64_t priority = GetPriority(state, vertex);
+        if (!queue.empty() && priority > queue.top().first) {
+            queue.push({priority, vertex});
+            continue;
+        }
+
+        ContractVertex(state, vertex, false);
+        state.contracted[vertex] = true;
+        data_.ranks[vertex] = rank++;
+
+        std::vector<VertexId> neighbors;
+        for (const EdgeId edge_id : state.out_edges[vertex]) {
+            neighbors.push_back(GetHierarchyEdge(edge_id).to);
+        }
+        for (const EdgeId edge_id : state.in_edges[vertex]) {
+            neighbors.push_back(GetHierarchyEdge(edge_id).from);
+        }
+        std::sort(neighbors.begin(), neighbors.end());
+        neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+
+        for (const VertexId neighbor : neighbors) {
+            if (!state.contracted[neighbor]) {
+                ++state.deleted_neighbors[neighbor];
+                CompactNeighborEdges(state, neighbor);
+            }
+        }
+    }
+}
+
+// Keeps only the cheapest edge to every uncontracted neighbour so that witness searches
+// do not rescan parallel bus edges and edges leading into the contracted part of the graph
+template <typename Weight>
+void ContractionHierarchy<Weight>::CompactNeighborEdges(ContractionState& state, VertexId vertex) const {
+    for (const bool outgoing : {true, false}) {
+        auto& edges = outgoing ? state.out_edges[vertex] : state.in_edges[vertex];
+        const auto neighbor_edges = GetCheapestNeighborEdges(state, vertex, outgoing);
+
+        edges.clear();
+        for (const auto& [_, edge_id] : neighbor_edges) {
+            edges.push_back(edge_id);
+        }
+    }
+}
+
+template <typename Weight>
+int64_t ContractionHierarchy<Weight>::GetPriority(ContractionState& state, VertexId vertex) {
+    const int64_t shortcut_count = ContractVertex(state, vertex, true);
+    const int64_t removed_count = static_cast<int64_t>(GetCheapestNeighborEdges(state, vertex, false).size()
+                                                       + GetCheapestNeighborEdges(state, vertex, true).size());
+    return shortcut_count - removed_count + state.deleted_neighbors[vertex];
+}
+
+template <typename Weight>
+std::vector<std::pair<VertexId, EdgeId>> ContractionHierarchy<Weight>::GetCheapestNeighborEdges(
+    const ContractionState& state, VertexId vertex, bool outgoing) const {
+    std::vector<std::pair<VertexId, EdgeId>> result;
+
+    for (const EdgeId edge_id : outgoing ? state.out_edges[vertex] : state.in_edges[vertex]) {
+        const auto edge = GetHierarchyEdge(edge_id);
+        const VertexId neighbor = outgoing ? edge.to : edge.from;
+        if (neighbor != vertex && !state.contracted[neighbor]) {
+            result.emplace_back(neighbor, edge_id);
+        }
+    }
+
+    std::sort(result.begin(), result.end(), [this](const auto& lhs, const auto& rhs) {
+        if (lhs.first != rhs.first) {
+            return lhs.first < rhs.first;
+        }
+        return GetHierarchyEdge(lhs.second).weight < GetHierarchyEdge(rhs.second).weight;
+    });
+    result.erase(std::unique(result.begin(), result.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first == rhs.first;
+    }), result.end());
+
+    return result;
+}
+
+template <typename Weight>
+int64_t ContractionHierarchy<Weight>::ContractVertex(ContractionState& state, VertexId vertex, bool simulate) {
+    const auto in_neighbors = GetCheapestNeighborEdges(state, vertex, false);
+    const auto out_neighbors = GetCheapestNeighborEdges(state, vertex, true);
+    if (in_neighbors.empty() || out_neighbors.empty()) {
+        return 0;
+    }
+
+    Weight max_out_weight = ZERO_WEIGHT;
+    for (const auto& [_, edge_id] : out_neighbors) {
+        max_out_weight = std::max(max_out_weight, GetHierarchyEdge(edge_id).weight);
+    }
+
+    int64_t shortcut_count = 0;
+    for (const auto& [from, in_edge_id] : in_neighbors) {
+        const Weight in_weight = GetHierarchyEdge(in_edge_id).weight;
+        RunWitnessSearch(state, from, vertex, in_weight + max_out_weight);
+
+        for (const auto& [to, out_edge_id] : out_neighbors) {
+            if (to == from) {
+                continue;
+            }
+
+            const Weight candidate_weight = in_weight + GetHierarchyEdge(out_edge_id).weight;
+            const auto& witness_weight = state.witness_weights[to];
+            if (witness_weight && !(candidate_weight < *witness_weight)) {
+                continue;
+            }
+
+            ++shortcut_count;
+            if (!simulate) {
+                const EdgeId shortcut_id = data_.edge_count + data_.shortcuts.size();
+                data_.shortcuts.push_back({from, to, candidate_weight, in_edge_id, out_edge_id});
+                state.out_edges[from].push_back(shortcut_id);
+                state.in_edges[to].push_back(shortcut_id);
+            }
+        }
+    }
+
+    return shortcut_count;
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::RunWitnessSearch(ContractionState& state, VertexId source, VertexId excluded,
+                                                    Weight max_weight) const {
+    for (const VertexId vertex : state.witness_touched) {
+        state.witness_weights[vertex].reset();
+    }
+    state.witness_touched.clear();
+
+    Queue queue;
+    state.witness_weights[source] = ZERO_WEIGHT;
+    state.witness_touched.push_back(source);
+    queue.push({ZERO_WEIGHT, source});
+
+    size_t settled_count = 0;
+    while (!queue.empty() && settled_count < WITNESS_SETTLE_LIMIT) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+
+        if (weight > *state.witness_weights[vertex]) {
+            continue;
+        }
+        if (weight > max_weight) {
+            break;
+        }
+        ++settled_count;
+
+        for (const EdgeId edge_id : state.out_edges[vertex]) {
+            const auto edge = GetHierarchyEdge(edge_id);
+            if (edge.to == excluded || state.contracted[edge.to]) {
+                continue;
+            }
+
+            const Weight candidate_weight = weight + edge.weight;
+            auto& target_weight = state.witness_weights[edge.to];
+            if (!target_weight || candidate_weight < *target_weight) {
+                if (!target_weight) {
+                    state.witness_touched.push_back(edge.to);
+                }
+                target_weight = candidate_weight;
+                queue.push({candidate_weight, edge.to});
+            }
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::BuildSearchGraph() {
+    upward_edges_.assign(data_.vertex_count, {});
+    downward_edges_.assign(data_.vertex_count, {});
+
+    const size_t total_edge_count = data_.edge_count + data_.shortcuts.size();
+    for (EdgeId edge_id = 0; edge_id < total_edge_count; ++edge_id) {
+        const auto edge = GetHierarchyEdge(edge_id);
+        if (data_.ranks[edge.from] < data_.ranks[edge.to]) {
+            upward_edges_[edge.from].push_back(edge_id);
+        }
+        else if (data_.ranks[edge.from] > data_.ranks[edge.to]) {
+            downward_edges_[edge.to].push_back(edge_id);
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::Step(SearchSpace& current, const SearchSpace& opposite,
+                                        const AdjacencyLists& adjacency, bool forward,
+                                        std::optional<Weight>& best_weight, VertexId& meeting_vertex) const {
+    const auto [weight, vertex] = current.queue.top();
+    current.queue.pop();
+
+    if (weight > *current.weights[vertex]) {
+        return;
+    }
+
+    if (const auto& opposite_weight = opposite.weights[vertex]) {
+        const Weight candidate_weight = weight + *opposite_weight;
+        if (!best_weight || candidate_weight < *best_weight) {
+            best_weight = candidate_weight;
+            meeting_vertex = vertex;
+        }
+    }
+
+    for (const EdgeId edge_id : adjacency[vertex]) {
+        const auto edge = GetHierarchyEdge(edge_id);
+        const VertexId neighbor = forward ? edge.to : edge.from;
+        const Weight candidate_weight = weight + edge.weight;
+        auto& target_weight = current.weights[neighbor];
+        if (!target_weight || candidate_weight < *target_weight) {
+            target_weight = candidate_weight;
+            current.prev_edges[neighbor] = edge_id;
+            current.queue.push({candidate_weight, neighbor});
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename ContractionHierarchy<Weight>::RouteInfo> ContractionHierarchy<Weight>::BuildRoute(
+    VertexId from, VertexId to) const {
+    if (from >= data_.vertex_count || to >= data_.vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    SearchSpace forward(data_.vertex_count);
+    SearchSpace backward(data_.vertex_count);
+    forward.weights[from] = ZERO_WEIGHT;
+    forward.queue.push({ZERO_WEIGHT, from});
+    backward.weights[to] = ZERO_WEIGHT;
+    backward.queue.push({ZERO_WEIGHT, to});
+
+    std::optional<Weight> best_weight;
+    VertexId meeting_vertex = from;
+
+    while (true) {
+        const bool forward_active = !forward.queue.empty()
+            && (!best_weight || forward.queue.top().weight < *best_weight);
+        const bool backward_active = !backward.queue.empty()
+            && (!best_weight || backward.queue.top().weight < *best_weight);
+
+        if (!forward_active && !backward_active) {
+            break;
+        }
+
+        if (forward_active && (!backward_active || !(backward.queue.top().weight < forward.queue.top().weight))) {
+            Step(forward, backward, upward_edges_, true, best_weight, meeting_vertex);
+        }
+        else {
+            Step(backward, forward, downward_edges_, false, best_weight, meeting_vertex);
+        }
+    }
+
+    if (!best_weight) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> hierarchy_edges;
+    for (std::optional<EdgeId> edge_id = forward.prev_edges[meeting_vertex];
+         edge_id;
+         edge_id = forward.prev_edges[GetHierarchyEdge(*edge_id).from])
+    {
+        hierarchy_edges.push_back(*edge_id);
+    }
+    std::reverse(hierarchy_edges.begin(), hierarchy_edges.end());
+
+    for (std::optional<EdgeId> edge_id = backward.prev_edges[meeting_vertex];
+         edge_id;
+         edge_id = backward.prev_edges[GetHierarchyEdge(*edge_id).to])
+    {
+        hierarchy_edges.push_back(*edge_id);
+    }
+
+    std::vector<EdgeId> edges;
+    for (const EdgeId edge_id : hierarchy_edges) {
+        UnpackEdge(edge_id, edges);
+    }
+
+    return RouteInfo{*best_weight, std::move(edges)};
+}
+
+template <typename Weight>
+template <typename Visitor>
+void ContractionHierarchy<Weight>::ExploreSearchSpace(SearchSpace& space, VertexId start, bool forward,
+                                                      Visitor visit) const {
+    if (start >= data_.vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    const AdjacencyLists& adjacency = forward ? upward_edges_ : downward_edges_;
+    std::vector<VertexId> touched{start};
+    space.weights[start] = ZERO_WEIGHT;
+    space.queue.push({ZERO_WEIGHT, start});
+
+    while (!space.queue.empty()) {
+        const auto [weight, vertex] = space.queue.top();
+        space.queue.pop();
+        if (weight > *space.weights[vertex]) {
+            continue;
+        }
+        visit(vertex, weight);
+
+        for (const EdgeId edge_id : adjacency[vertex]) {
+            const auto edge = GetHierarchyEdge(edge_id);
+            const VertexId neighbor = forward ? edge.to : edge.from;
+            const Weight candidate_weight = weight + edge.weight;
+            auto& target_weight = space.weights[neighbor];
+            if (!target_weight) {
+                touched.push_back(neighbor);
+            }
+            if (!target_weight || candidate_weight < *target_weight) {
+                target_weight = candidate_weight;
+                space.queue.push({candidate_weight, neighbor});
+            }
+        }
+    }
+
+    for (const VertexId vertex : touched) {
+        space.weights[vertex].reset();
+    }
+}
+
+template <typename Weight>
+std::vector<std::vector<std::optional<Weight>>> ContractionHierarchy<Weight>::BuildWeightMatrix(
+    const std::vector<VertexId>& sources, const std::vector<VertexId>& targets) const {
+    struct BucketEntry {
+        size_t target_index;
+        Weight weight;
+    };
+    std::vector<std::vector<BucketEntry>> buckets(data_.vertex_count);
+    SearchSpace space(data_.vertex_count);
+
+    for (size_t target_index = 0; target_index < targets.size(); ++target_index) {
+        ExploreSearchSpace(space, targets[target_index], false, [&buckets, target_index](VertexId vertex, Weight weight) {
+            buckets[vertex].push_back({target_index, weight});
+        });
+    }
+
+    std::vector<std::vector<std::optional<Weight>>> result(sources.size(),
+                                                           std::vector<std::optional<Weight>>(targets.size()));
+    for (size_t source_index = 0; source_index < sources.size(); ++source_index) {
+        auto& row = result[source_index];
+        ExploreSearchSpace(space, sources[source_index], true, [&buckets, &row](VertexId vertex, Weight weight) {
+            for (const auto& [target_index, target_weight] : buckets[vertex]) {
+                const Weight candidate_weight = weight + target_weight;
+                if (!row[target_index] || candidate_weight < *row[target_index]) {
+                    row[target_index] = candidate_weight;
+                }
+            }
+        });
+    }
+
+    return result;
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::UnpackEdge(EdgeId edge_id, std::vector<EdgeId>& edges) const {
+    std::vector<EdgeId> stack{edge_id};
+
+    while (!stack.empty()) {
+        const EdgeId current = stack.back();
+        stack.pop_back();
+
+        if (current < data_.edge_count) {
+            edges.push_back(current);
+            continue;
+        }
+
+        const auto& shortcut = data_.shortcuts[current - data_.edge_count];
+        stack.push_back(shortcut.second_edge);
+        stack.push_back(shortcut.first_edge);
+    }
+}
+
+}  // namespace graph
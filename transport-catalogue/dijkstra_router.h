@@ -0,0 +1,360 @@
+#pragma once
+
+#include "graph.h"
+#include "radix_heap.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Point-to-point router that runs a binary-heap Dijkstra search per query
+// instead of precomputing the all-pairs table. Memory is linear in the graph.
+// Given a potential (a lower bound on the remaining weight to the target that never
+// decreases by more than an edge weight along the edge) the search becomes A*.
+// Unsigned integer weights use a radix heap instead of the binary one.
+template <typename Weight>
+class DijkstraRouter {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = graph::RouteInfo<Weight>;
+
+    // Weights and last edges of the shortest routes from one vertex to every vertex it reaches
+    struct ShortestPathTree {
+        VertexId root = 0;
+        std::vector<std::optional<Weight>> weights;
+        std::vector<std::optional<EdgeId>> prev_edges;
+    };
+
+    explicit DijkstraRouter(const Graph& graph);
+
+    // A single search answers any number of queries sharing the origin. With max_weight the
+    // tree only covers vertices reachable within it and the search never looks further.
+    ShortestPathTree BuildShortestPathTree(VertexId from, std::optional<Weight> max_weight = std::nullopt) const {
+        return Search(from, std::nullopt, [](VertexId) {
+            return ZERO_WEIGHT;
+        }, max_weight, NoEdgeBlocked{});
+    }
+
+    std::optional<RouteInfo> BuildRoute(const ShortestPathTree& tree, VertexId to) const;
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const {
+        return BuildRoute(from, to, [](VertexId) {
+            return ZERO_WEIGHT;
+        });
+    }
+
+    template <typename Potential>
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to, const Potential& potential) const {
+        return BuildRoute(Search(from, to, potential, std::nullopt, NoEdgeBlocked{}), to);
+    }
+
+    // Route that never takes an edge for which is_blocked(edge_id) holds, without changing
+    // the graph. Serves the spur searches of alternative routes.
+    template <typename EdgeFilter>
+    std::optional<RouteInfo> BuildRouteAvoiding(VertexId from, VertexId to, const EdgeFilter& is_blocked) const {
+        return BuildRoute(Search(from, to, [](VertexId) {
+            return ZERO_WEIGHT;
+        }, std::nullopt, is_blocked), to);
+    }
+
+    // Searches forward from `from` and backward from `to` at the same time and stops once
+    // the two frontiers can no longer improve the best route meeting between them
+    std::optional<RouteInfo> BuildBidirectionalRoute(VertexId from, VertexId to) const;
+
+    // Fastest route with at most max_count edges for which is_counted(edge_id) holds. Labels
+    // are (weight, count) pairs; as they settle in weight order, a label is dropped once its
+    // vertex has settled one with no greater count, so every vertex settles at most
+    // max_count + 1 labels.
+    template <typename IsCounted>
+    std::optional<RouteInfo> BuildLimitedRoute(VertexId from, VertexId to, const IsCounted& is_counted, size_t max_count) const;
+
+private:
+    struct QueueItem {
+        Weight priority;
+        Weight weight;
+        VertexId vertex;
+
+        bool operator>(const QueueItem& other) const {
+            return priority > other.priority;
+        }
+    };
+    struct ItemPriority {
+        template <typename Item>
+        Weight operator()(const Item& item) const {
+            return item.priority;
+        }
+    };
+    // Priorities never decrease while a search runs, as the radix heap requires
+    template <typename Item>
+    using PriorityQueue = std::conditional_t<std::is_integral_v<Weight> && std::is_unsigned_v<Weight>,
+                                             RadixHeap<Item, ItemPriority>,
+                                             std::priority_queue<Item, std::vector<Item>, std::greater<Item>>>;
+    using Queue = PriorityQueue<QueueItem>;
+
+    // Labels of one direction of the bidirectional search. Edges are the last edge of the
+    // route to the vertex for the forward search and the first edge from it for the backward one.
+    struct SearchState {
+        std::vector<std::optional<Weight>> weights;
+        std::vector<std::optional<EdgeId>> edges;
+        Queue queue;
+    };
+
+    struct NoEdgeBlocked {
+        bool operator()(EdgeId) const {
+            return false;
+        }
+    };
+
+    // Stops as soon as the target is settled, the labels of the other vertices may then be tentative
+    template <typename Potential, typename EdgeFilter>
+    ShortestPathTree Search(VertexId from, std::optional<VertexId> to, const Potential& potential,
+                            std::optional<Weight> max_weight, const EdgeFilter& is_blocked) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+};
+
+template <typename Weight>
+DijkstraRouter<Weight>::DijkstraRouter(const Graph& graph)
+    : graph_(graph)
+{
+    const size_t edge_count = graph.GetEdgeCount();
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight>
+template <typename Potential, typename EdgeFilter>
+typename DijkstraRouter<Weight>::ShortestPathTree DijkstraRouter<Weight>::Search(VertexId from,
+                                                                                 std::optional<VertexId> to,
+                                                                                 const Potential& potential,
+                                                                                 std::optional<Weight> max_weight,
+                                                                                 const EdgeFilter& is_blocked) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count || (to && *to >= vertex_count)) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    ShortestPathTree tree{from, std::vector<std::optional<Weight>>(vertex_count), std::vector<std::optional<EdgeId>>(vertex_count)};
+    auto& weights = tree.weights;
+    auto& prev_edges = tree.prev_edges;
+
+    Queue queue;
+    weights[from] = ZERO_WEIGHT;
+    queue.push({potential(from), ZERO_WEIGHT, from});
+
+    while (!queue.empty()) {
+        const auto [priority, weight, vertex] = queue.top();
+        queue.pop();
+
+        if (weight > *weights[vertex]) {
+            continue;
+        }
+        if (vertex == to) {
+            break;
+        }
+
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            if (is_blocked(edge_id)) {
+                continue;
+            }
+            const auto& edge = graph_.GetEdge(edge_id);
+            const Weight candidate_weight = weight + edge.weight;
+            if (max_weight && *max_weight < candidate_weight) {
+                continue;
+            }
+            auto& target_weight = weights[edge.to];
+            if (!target_weight || candidate_weight < *target_weight) {
+                target_weight = candidate_weight;
+                prev_edges[edge.to] = edge_id;
+                queue.push({candidate_weight + potential(edge.to), candidate_weight, edge.to});
+            }
+        }
+    }
+
+    return tree;
+}
+
+template <typename Weight>
+std::optional<typename DijkstraRouter<Weight>::RouteInfo> DijkstraRouter<Weight>::BuildRoute(const ShortestPathTree& tree,
+                                                                                             VertexId to) const {
+    if (to >= tree.weights.size()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    if (!tree.weights[to]) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> edges;
+    for (std::optional<EdgeId> edge_id = tree.prev_edges[to];
+         edge_id;
+         edge_id = tree.prev_edges[graph_.GetEdge(*edge_id).from])
+    {
+        edges.push_back(*edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return RouteInfo{*tree.weights[to], std::move(edges)};
+}
+
+template <typename Weight>
+std::optional<typename DijkstraRouter<Weight>::RouteInfo> DijkstraRouter<Weight>::BuildBidirectionalRoute(VertexId from,
+                                                                                                          VertexId to) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    SearchState forward{std::vector<std::optional<Weight>>(vertex_count), std::vector<std::optional<EdgeId>>(vertex_count), {}};
+    SearchState backward{std::vector<std::optional<Weight>>(vertex_count), std::vector<std::optional<EdgeId>>(vertex_count), {}};
+    forward.weights[from] = ZERO_WEIGHT;
+    forward.queue.push({ZERO_WEIGHT, ZERO_WEIGHT, from});
+    backward.weights[to] = ZERO_WEIGHT;
+    backward.queue.push({ZERO_WEIGHT, ZERO_WEIGHT, to});
+
+    std::optional<Weight> best_weight;
+    VertexId meeting_vertex = from;
+    if (from == to) {
+        best_weight = ZERO_WEIGHT;
+    }
+
+    // An exhausted direction has settled everything it reaches, so the best meeting is final
+    while (!forward.queue.empty() && !backward.queue.empty()) {
+        if (best_weight && forward.queue.top().weight + backward.queue.top().weight >= *best_weight) {
+            break;
+        }
+
+        const bool is_forward = forward.queue.top().weight <= backward.queue.top().weight;
+        SearchState& state = is_forward ? forward : backward;
+        const SearchState& other = is_forward ? backward : forward;
+
+        const auto [priority, weight, vertex] = state.queue.top();
+        state.queue.pop();
+        if (weight > *state.weights[vertex]) {
+            continue;
+        }
+
+        const auto edge_ids = is_forward ? graph_.GetIncidentEdges(vertex) : graph_.GetIngoingEdges(vertex);
+        for (const EdgeId edge_id : edge_ids) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            const VertexId next_vertex = is_forward ? edge.to : edge.from;
+            const Weight candidate_weight = weight + edge.weight;
+            auto& target_weight = state.weights[next_vertex];
+            if (target_weight && !(candidate_weight < *target_weight)) {
+                continue;
+            }
+            target_weight = candidate_weight;
+            state.edges[next_vertex] = edge_id;
+            state.queue.push({candidate_weight, candidate_weight, next_vertex});
+
+            if (const auto& other_weight = other.weights[next_vertex];
+                other_weight && (!best_weight || candidate_weight + *other_weight < *best_weight)) {
+                best_weight = candidate_weight + *other_weight;
+                meeting_vertex = next_vertex;
+            }
+        }
+    }
+
+    if (!best_weight) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> edges;
+    for (std::optional<EdgeId> edge_id = forward.edges[meeting_vertex];
+         edge_id;
+         edge_id = forward.edges[graph_.GetEdge(*edge_id).from])
+    {
+        edges.push_back(*edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+    for (std::optional<EdgeId> edge_id = backward.edges[meeting_vertex];
+         edge_id;
+         edge_id = backward.edges[graph_.GetEdge(*edge_id).to])
+    {
+        edges.push_back(*edge_id);
+    }
+
+    return RouteInfo{*best_weight, std::move(edges)};
+}
+
+template <typename Weight>
+template <typename IsCounted>
+std::optional<typename DijkstraRouter<Weight>::RouteInfo> DijkstraRouter<Weight>::BuildLimitedRoute(VertexId from,
+                                                                                                    VertexId to,
+                                                                                                    const IsCounted& is_counted,
+                                                                                                    size_t max_count) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    struct Label {
+        Weight weight;
+        size_t count;
+        VertexId vertex;
+        std::optional<EdgeId> edge;
+        size_t parent;
+    };
+    struct LabelItem {
+        Weight priority;
+        size_t label;
+
+        bool operator>(const LabelItem& other) const {
+            return priority > other.priority;
+        }
+    };
+
+    constexpr size_t NOT_SETTLED = std::numeric_limits<size_t>::max();
+    // Fewest counted edges among the labels settled at every vertex
+    std::vector<size_t> settled_counts(vertex_count, NOT_SETTLED);
+    std::vector<Label> labels{{ZERO_WEIGHT, 0, from, std::nullopt, 0}};
+    PriorityQueue<LabelItem> queue;
+    queue.push({ZERO_WEIGHT, 0});
+
+    while (!queue.empty()) {
+        const size_t label_id = queue.top().label;
+        queue.pop();
+        const Label label = labels[label_id];
+        if (settled_counts[label.vertex] <= label.count) {
+            continue;
+        }
+        settled_counts[label.vertex] = label.count;
+
+        if (label.vertex == to) {
+            std::vector<EdgeId> edges;
+            for (size_t id = label_id; labels[id].edge; id = labels[id].parent) {
+                edges.push_back(*labels[id].edge);
+            }
+            std::reverse(edges.begin(), edges.end());
+            return RouteInfo{label.weight, std::move(edges)};
+        }
+
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(label.vertex)) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            const size_t count = label.count + (is_counted(edge_id) ? 1 : 0);
+            if (count > max_count || settled_counts[edge.to] <= count) {
+                continue;
+            }
+            const Weight weight = label.weight + edge.weight;
+            labels.push_back({weight, count, edge.to, edge_id, label_id});
+            queue.push({weight, labels.size() - 1});
+        }
+    }
+
+    return std::nullopt;
+}
+
+}  // namespace graph
@@ -3,7 +3,10 @@
 #include "geo.h"
 #include "graph.h"
 
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <unordered_map>
 #include <variant>
 #include <vector>
 
@@ -15,6 +18,15 @@ struct Stat {
 	std::string name;
     std::string from;
     std::string to;
+    // Stop lists of a RouteMatrix request
+    std::vector<std::string> from_stops;
+    std::vector<std::string> to_stops;
+    // Time budget of an Isochrone request, in minutes
+    double max_time = 0;
+    // Transfer limit of a Route request
+    std::optional<size_t> max_transfers;
+    // Number of ranked routes a Route request asks for, the transfer limit does not apply to them
+    std::optional<size_t> alternatives;
 };
 
 struct Bus;
@@ -23,6 +35,8 @@ struct Stop {
     std::string name;
     transport_catalogue::detail::geo::Coordinates coords;
     std::vector<Bus*> buses;
+    // Dense position of the stop in the catalogue, assigned by TransportCatalogue::AddStop
+    size_t id = 0;
 };
 
 struct Bus {
@@ -30,6 +44,16 @@ struct Bus {
     std::vector<Stop*> stops;
     bool is_roundtrip;
     size_t route_length;
+    // Dense position of the bus in the catalogue, assigned by TransportCatalogue::AddBus
+    size_t id = 0;
+};
+
+// Route figures of a bus, computed once when the bus is added
+struct BusStats {
+    uint32_t unique_stop_count = 0;
+    size_t route_length = 0;
+    double geo_length = 0;
+    double curvature = 0;
 };
 
 struct Distance {
@@ -51,6 +75,8 @@ struct BusEdge {
     std::string_view name;
     size_t span_count = 0;
     double time = 0;
+    // Road distance of the ride in meters, the time is derived from it
+    size_t distance = 0;
 };
 
 struct StopQuery {
@@ -64,9 +90,52 @@ struct StopEdge {
     double time = 0;
 };
 
+enum class RouterType {
+    ALL_PAIRS,
+    DIJKSTRA,
+    CONTRACTION_HIERARCHY,
+    A_STAR,
+    BIDIRECTIONAL_DIJKSTRA,
+    RAPTOR,
+};
+
+// Storage of the all-pairs table: weights in double precision or narrowed to float
+enum class RoutesTableLayout {
+    WIDE,
+    COMPACT,
+};
+
+// Routing graph layout: a boarding and an alighting vertex per stop joined by a wait edge,
+// or one vertex per stop with the wait folded into every bus edge leaving it
+enum class GraphModel {
+    WAIT_VERTICES,
+    SINGLE_VERTEX,
+};
+
 struct RoutingSettings {
     double bus_wait_time = 0;
     double bus_velocity = 0;
+    RouterType router_type = RouterType::ALL_PAIRS;
+    // Worker threads used to precompute the all-pairs table, 0 means one per hardware thread
+    size_t thread_count = 0;
+    RoutesTableLayout routes_table_layout = RoutesTableLayout::WIDE;
+    GraphModel graph_model = GraphModel::WAIT_VERTICES;
+    // The all-pairs table and Dijkstra search a copy of the graph in whole tenths of a second
+    bool integer_weights = false;
+    // Route answers kept by origin and destination, 0 disables the cache
+    size_t route_cache_size = 0;
+    // Minutes between buses by bus name. The RAPTOR engine waits a full headway before boarding
+    // these buses instead of bus_wait_time, the graph engines do not use them.
+    std::unordered_map<std::string, double> bus_headways;
+    // Budget of one Route request with alternatives: spur searches and milliseconds, 0 is unlimited
+    size_t alternatives_max_searches = 500;
+    size_t alternatives_max_milliseconds = 100;
+};
+
+// Weights a process_requests batch re-tunes, only the keys it gives replace the stored ones
+struct RoutingSettingsOverride {
+    std::optional<double> bus_wait_time;
+    std::optional<double> bus_velocity;
 };
 
 struct WaitRange {
@@ -79,4 +148,12 @@ struct RouteGraphInfo {
     std::vector<std::variant<StopEdge, BusEdge>> edges;
 };
 
+// Total times between every origin (row) and destination (column), empty where there is no route
+using RouteMatrix = std::vector<std::vector<std::optional<double>>>;
+
+struct ReachableStop {
+    std::string_view name;
+    double time = 0;
+};
+
 } // namespace domain
\ No newline at end of file
@@ -2,7 +2,11 @@
 
 #include "ranges.h"
 
+#include <cstddef>
 #include <cstdlib>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
 namespace graph {
@@ -17,43 +21,163 @@ struct Edge {
     Weight weight;
 };
 
+template <typename Weight>
+struct RouteInfo {
+    Weight weight;
+    std::vector<EdgeId> edges;
+};
+
+// Walks either an incidence list or, in a frozen graph, a contiguous range of edge ids
+class IncidentEdgeIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = EdgeId;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const EdgeId*;
+    using reference = EdgeId;
+
+    explicit IncidentEdgeIterator(const EdgeId* position)
+        : position_(position) {
+    }
+    explicit IncidentEdgeIterator(EdgeId edge_id)
+        : edge_id_(edge_id) {
+    }
+
+    EdgeId operator*() const {
+        return position_ ? *position_ : edge_id_;
+    }
+    IncidentEdgeIterator& operator++() {
+        if (position_) {
+            ++position_;
+        }
+        else {
+            ++edge_id_;
+        }
+        return *this;
+    }
+    bool operator==(const IncidentEdgeIterator& other) const {
+        return position_ == other.position_ && edge_id_ == other.edge_id_;
+    }
+    bool operator!=(const IncidentEdgeIterator& other) const {
+        return !(*this == other);
+    }
+
+private:
+    const EdgeId* position_ = nullptr;
+    EdgeId edge_id_ = 0;
+};
+
+// Edges are collected in per-vertex incidence lists until Freeze() is called. Freezing
+// switches the graph to compressed sparse row form: edges are renumbered so that those
+// leaving a vertex occupy one contiguous id range, and only an offsets array remains.
+// Edges entering a vertex are indexed as well, for searches that walk the graph backwards.
 template <typename Weight>
 class DirectedWeightedGraph {
 private:
     using IncidenceList = std::vector<EdgeId>;
-    using IncidentEdgesRange = ranges::Range<typename IncidenceList::const_iterator>;
+    using IncidentEdgesRange = ranges::Range<IncidentEdgeIterator>;
 
 public:
     DirectedWeightedGraph() = default;
     explicit DirectedWeightedGraph(size_t vertex_count);
     EdgeId AddEdge(const Edge<Weight>& edge);
 
+    // Returns the new id of every edge, indexed by its id before freezing
+    std::vector<EdgeId> Freeze();
+    bool IsFrozen() const;
+
     size_t GetVertexCount() const;
     size_t GetEdgeCount() const;
     const Edge<Weight>& GetEdge(EdgeId edge_id) const;
+    // Changes the weight only, the topology and the ids stay as they are
+    void SetEdgeWeight(EdgeId edge_id, Weight weight);
     IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
+    IncidentEdgesRange GetIngoingEdges(VertexId vertex) const;
 
 private:
     std::vector<Edge<Weight>> edges_;
     std::vector<IncidenceList> incidence_lists_;
+    std::vector<IncidenceList> reverse_incidence_lists_;
+    std::vector<EdgeId> offsets_;
+    std::vector<EdgeId> reverse_offsets_;
+    std::vector<EdgeId> reverse_edge_ids_;
 };
 
 template <typename Weight>
 DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
-    : incidence_lists_(vertex_count) {
+    : incidence_lists_(vertex_count)
+    , reverse_incidence_lists_(vertex_count) {
 }
 
 template <typename Weight>
 EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
+    if (IsFrozen()) {
+        throw std::logic_error("Edges can't be added to a frozen graph");
+    }
+
     edges_.push_back(edge);
     const EdgeId id = edges_.size() - 1;
     incidence_lists_.at(edge.from).push_back(id);
+    reverse_incidence_lists_.at(edge.to).push_back(id);
     return id;
 }
 
+template <typename Weight>
+std::vector<EdgeId> DirectedWeightedGraph<Weight>::Freeze() {
+    std::vector<EdgeId> new_ids(edges_.size());
+    if (IsFrozen()) {
+        for (EdgeId edge_id = 0; edge_id < new_ids.size(); ++edge_id) {
+            new_ids[edge_id] = edge_id;
+        }
+        return new_ids;
+    }
+
+    const size_t vertex_count = incidence_lists_.size();
+    std::vector<EdgeId> offsets(vertex_count + 1, 0);
+    std::vector<Edge<Weight>> edges;
+    edges.reserve(edges_.size());
+
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        offsets[vertex] = edges.size();
+        for (const EdgeId edge_id : incidence_lists_[vertex]) {
+            new_ids[edge_id] = edges.size();
+            edges.push_back(edges_[edge_id]);
+        }
+    }
+    offsets[vertex_count] = edges.size();
+
+    // Edges entering each vertex, bucketed by their head in new id order
+    std::vector<EdgeId> reverse_offsets(vertex_count + 1, 0);
+    for (const auto& edge : edges) {
+        ++reverse_offsets[edge.to + 1];
+    }
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        reverse_offsets[vertex + 1] += reverse_offsets[vertex];
+    }
+    std::vector<EdgeId> reverse_edge_ids(edges.size());
+    std::vector<EdgeId> positions(reverse_offsets.begin(), reverse_offsets.end() - 1);
+    for (EdgeId edge_id = 0; edge_id < edges.size(); ++edge_id) {
+        reverse_edge_ids[positions[edges[edge_id].to]++] = edge_id;
+    }
+
+    edges_ = std::move(edges);
+    offsets_ = std::move(offsets);
+    reverse_offsets_ = std::move(reverse_offsets);
+    reverse_edge_ids_ = std::move(reverse_edge_ids);
+    std::vector<IncidenceList>().swap(incidence_lists_);
+    std::vector<IncidenceList>().swap(reverse_incidence_lists_);
+
+    return new_ids;
+}
+
+template <typename Weight>
+bool DirectedWeightedGraph<Weight>::IsFrozen() const {
+    return !offsets_.empty();
+}
+
 template <typename Weight>
 size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
-    return incidence_lists_.size();
+    return IsFrozen() ? offsets_.size() - 1 : incidence_lists_.size();
 }
 
 template <typename Weight>
@@ -66,9 +190,32 @@ const Edge<Weight>& DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const
     return edges_.at(edge_id);
 }
 
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::SetEdgeWeight(EdgeId edge_id, Weight weight) {
+    edges_.at(edge_id).weight = weight;
+}
+
 template <typename Weight>
 typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
 DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
-    return ranges::AsRange(incidence_lists_.at(vertex));
+    if (IsFrozen()) {
+        return {IncidentEdgeIterator(offsets_.at(vertex)), IncidentEdgeIterator(offsets_.at(vertex + 1))};
+    }
+
+    const auto& incidence_list = incidence_lists_.at(vertex);
+    return {IncidentEdgeIterator(incidence_list.data()), IncidentEdgeIterator(incidence_list.data() + incidence_list.size())};
+}
+
+template <typename Weight>
+typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
+DirectedWeightedGraph<Weight>::GetIngoingEdges(VertexId vertex) const {
+    if (IsFrozen()) {
+        const EdgeId* reverse_edge_ids = reverse_edge_ids_.data();
+        return {IncidentEdgeIterator(reverse_edge_ids + reverse_offsets_.at(vertex)),
+                IncidentEdgeIterator(reverse_edge_ids + reverse_offsets_.at(vertex + 1))};
+    }
+
+    const auto& incidence_list = reverse_incidence_lists_.at(vertex);
+    return {IncidentEdgeIterator(incidence_list.data()), IncidentEdgeIterator(incidence_list.data() + incidence_list.size())};
 }
 }  // namespace graph
\ No newline at end of file
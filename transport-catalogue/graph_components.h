@@ -0,0 +1,124 @@
+#pragma once
+
+#include "graph.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Tarjan's algorithm with an explicit stack. Components are numbered in reverse topological
+// order of the condensation: an edge between two components always leads to a smaller id,
+// so no vertex can reach a vertex of a component with a greater id.
+template <typename Weight>
+std::vector<size_t> ComputeStrongComponents(const DirectedWeightedGraph<Weight>& graph) {
+    constexpr size_t UNVISITED = std::numeric_limits<size_t>::max();
+    const size_t vertex_count = graph.GetVertexCount();
+
+    std::vector<size_t> components(vertex_count, UNVISITED);
+    std::vector<size_t> indices(vertex_count, UNVISITED);
+    std::vector<size_t> low_links(vertex_count, 0);
+    std::vector<VertexId> component_stack;
+    // Vertex being explored and its incident edges not examined yet
+    struct Frame {
+        VertexId vertex;
+        IncidentEdgeIterator next_edge;
+        IncidentEdgeIterator end_edge;
+    };
+    std::vector<Frame> call_stack;
+    size_t next_index = 0;
+    size_t component_count = 0;
+
+    auto visit = [&](VertexId vertex) {
+        indices[vertex] = low_links[vertex] = next_index++;
+        component_stack.push_back(vertex);
+        const auto edges = graph.GetIncidentEdges(vertex);
+        call_stack.push_back({vertex, edges.begin(), edges.end()});
+    };
+
+    for (VertexId root = 0; root < vertex_count; ++root) {
+        if (indices[root] != UNVISITED) {
+            continue;
+        }
+        visit(root);
+
+        while (!call_stack.empty()) {
+            Frame& frame = call_stack.back();
+            const VertexId vertex = frame.vertex;
+
+            if (frame.next_edge != frame.end_edge) {
+                const VertexId next_vertex = graph.GetEdge(*frame.next_edge).to;
+                ++frame.next_edge;
+                if (indices[next_vertex] == UNVISITED) {
+                    visit(next_vertex);
+                }
+                else if (components[next_vertex] == UNVISITED) {
+                    low_links[vertex] = std::min(low_links[vertex], indices[next_vertex]);
+                }
+                continue;
+            }
+
+            if (low_links[vertex] == indices[vertex]) {
+                VertexId member;
+                do {
+                    member = component_stack.back();
+                    component_stack.pop_back();
+                    components[member] = component_count;
+                } while (member != vertex);
+                ++component_count;
+            }
+
+            call_stack.pop_back();
+            if (!call_stack.empty()) {
+                const VertexId parent = call_stack.back().vertex;
+                low_links[parent] = std::min(low_links[parent], low_links[vertex]);
+            }
+        }
+    }
+
+    return components;
+}
+
+// Components of the graph with edge directions ignored, numbered from 0 in order of their
+// smallest vertex
+template <typename Weight>
+std::vector<size_t> ComputeWeakComponents(const DirectedWeightedGraph<Weight>& graph) {
+    const size_t vertex_count = graph.GetVertexCount();
+    std::vector<VertexId> parents(vertex_count);
+    std::iota(parents.begin(), parents.end(), 0);
+
+    auto find_root = [&parents](VertexId vertex) {
+        while (parents[vertex] != vertex) {
+            parents[vertex] = parents[parents[vertex]];
+            vertex = parents[vertex];
+        }
+        return vertex;
+    };
+
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        const auto& edge = graph.GetEdge(edge_id);
+        const VertexId from_root = find_root(edge.from);
+        const VertexId to_root = find_root(edge.to);
+        if (from_root != to_root) {
+            parents[std::max(from_root, to_root)] = std::min(from_root, to_root);
+        }
+    }
+
+    std::vector<size_t> components(vertex_count);
+    std::vector<size_t> root_components(vertex_count, std::numeric_limits<size_t>::max());
+    size_t component_count = 0;
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        const VertexId root = find_root(vertex);
+        if (root_components[root] == std::numeric_limits<size_t>::max()) {
+            root_components[root] = component_count++;
+        }
+        components[vertex] = root_components[root];
+    }
+
+    return components;
+}
+
+}  // namespace graph
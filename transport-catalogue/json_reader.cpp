@@ -48,11 +48,11 @@ void Reader::ParseNodeMakeBase(TransportCatalogue& catalogue, map_renderer::Rend
 	}
 
 	else {
-		std::cout << "Failed to parse make_base request: root is not a map-type";
+		std::cerr << "Failed to parse make_base request: root is not a map-type";
 	}
 }
 
-void Reader::ParseNodeProcessRequests(std::vector<Stat>& stats, serialization::SerializationSettings& serialization_settings) {
+void Reader::ParseNodeProcessRequests(std::vector<Stat>& stats, serialization::SerializationSettings& serialization_settings, router::RoutingSettingsOverride& routing_settings_override) {
 	Dict root;
 
 	if (document_.GetRoot().IsDict()) {
@@ -67,10 +67,14 @@ void Reader::ParseNodeProcessRequests(std::vector<Stat>& stats, serialization::S
 			ParseNodeSerialization(root.at("serialization_settings"), serialization_settings);
 		}
 		catch (...) { }
+
+		if (root.count("routing_settings")) {
+			ParseNodeRouteOverride(root.at("routing_settings"), routing_settings_override);
+		}
 	}
 
 	else {
-		std::cout << "Failed to parse process_requests request: root is not a map-type";
+		std::cerr << "Failed to parse process_requests request: root is not a map-type";
 	}
 }
 
@@ -84,7 +88,7 @@ void Reader::ParseNode(const Node& root, TransportCatalogue& catalogue, std::vec
 			ParseNodeBase(dict.at("base_requests"), catalogue);
 		}
 		catch (...) {
-			std::cout << "Failed to parse a query: base_requests is empty"sv;
+			std::cerr << "Failed to parse a query: base_requests is empty"sv;
 		}
 
 		try {
@@ -98,19 +102,19 @@ void Reader::ParseNode(const Node& root, TransportCatalogue& catalogue, std::vec
 			ParseNodeRender(dict.at("render_settings"), render_settings);
 		}
 		catch (...) {
-			std::cout << "Failed to parse a query: render settings are empty"sv;
+			std::cerr << "Failed to parse a query: render settings are empty"sv;
 		}
 
 		try {
 			ParseNodeRoute(dict.at("routing_settings"), routing_settings);
 		}
 		catch (...) {
-			std::cout << "Failed to parse a query: route settings are empty";
+			std::cerr << "Failed to parse a query: route settings are empty";
 		}
 	}
 
 	else {
-		std::cout << "Failed to parse a query: root is not a map-type"sv;
+		std::cerr << "Failed to parse a query: root is not a map-type"sv;
 	}
 }
 
@@ -139,13 +143,13 @@ void Reader::ParseNodeBase(const Node& root, TransportCatalogue& catalogue) {
 							stops.push_back(dict);
 						}
 						else {
-							std::cout << "Failed to parse a query: base_requests have a wrong type"sv;
+							std::cerr << "Failed to parse a query: base_requests have a wrong type"sv;
 						}
 					}
 				}
 
 				catch (...) {
-					std::cout << "Failed to parse a query: base_requests don't have a \"type\" value"sv;
+					std::cerr << "Failed to parse a query: base_requests don't have a \"type\" value"sv;
 				}
 			}
 		}
@@ -166,7 +170,7 @@ void Reader::ParseNodeBase(const Node& root, TransportCatalogue& catalogue) {
 	}
 
 	else {
-		std::cout << "Failed to parse a query: base_requests is not an array-type"sv;
+		std::cerr << "Failed to parse a query: base_requests is not an array-type"sv;
 	}
 }
 
@@ -196,6 +200,18 @@ void Reader::ParseNodeStat(const Node& node, std::vector<Stat>& stats) {
 					if (stat_node.type == "Route") {
 						stat_node.from = dict.at("from").AsString();
 						stat_node.to = dict.at("to").AsString();
+						stat_node.max_transfers.reset();
+						if (dict.count("max_transfers") && dict.at("max_transfers").IsInt()) {
+							stat_node.max_transfers = std::max(0, dict.at("max_transfers").AsInt());
+						}
+						stat_node.alternatives.reset();
+						if (dict.count("alternatives") && dict.at("alternatives").IsInt()) {
+							stat_node.alternatives = std::max(0, dict.at("alternatives").AsInt());
+						}
+					}
+					else if (stat_node.type == "Isochrone") {
+						stat_node.from = dict.at("from").AsString();
+						stat_node.to = "";
 					}
 					else {
 						stat_node.from = "";
@@ -203,6 +219,18 @@ void Reader::ParseNodeStat(const Node& node, std::vector<Stat>& stats) {
 					}
 				}
 
+				stat_node.from_stops.clear();
+				stat_node.to_stops.clear();
+				stat_node.max_time = stat_node.type == "Isochrone" ? dict.at("max_time").AsDouble() : 0;
+				if (stat_node.type == "RouteMatrix") {
+					for (const auto& stop : dict.at("from").AsArray()) {
+						stat_node.from_stops.push_back(stop.AsString());
+					}
+					for (const auto& stop : dict.at("to").AsArray()) {
+						stat_node.to_stops.push_back(stop.AsString());
+					}
+				}
+
 				stats.push_back(stat_node);
 			}
 		}
@@ -210,7 +238,7 @@ void Reader::ParseNodeStat(const Node& node, std::vector<Stat>& stats) {
 	}
 
 	else {
-		std::cout << "Failed to parse a query: base_requests is not an array-type"sv;
+		std::cerr << "Failed to parse a query: base_requests is not an array-type"sv;
 	}
 }
 
@@ -301,7 +329,7 @@ void Reader::ParseNodeRender(const Node& node, map_renderer::RenderSettings& ren
 	}
 
 	else {
-		std::cout << "Failed to parse a query: render_settings is not a map-type"sv;
+		std::cerr << "Failed to parse a query: render_settings is not a map-type"sv;
 	}
 }
 
@@ -316,12 +344,161 @@ void Reader::ParseNodeRoute(const Node& node, router::RoutingSettings& routing_s
 			routing_settings.bus_velocity = route.at("bus_velocity").AsDouble();
 		}
 		catch (...) {
-			std::cout << "Failed to parse route settings";
+			std::cerr << "Failed to parse route settings" << std::endl;
+		}
+
+		if (route.count("router")) {
+			ParseNodeRouterType(route.at("router"), routing_settings);
+		}
+
+		if (route.count("thread_count") && route.at("thread_count").IsInt()) {
+			routing_settings.thread_count = std::max(0, route.at("thread_count").AsInt());
+		}
+
+		if (route.count("all_pairs_layout")) {
+			ParseNodeRoutesTableLayout(route.at("all_pairs_layout"), routing_settings);
+		}
+
+		if (route.count("graph_model")) {
+			ParseNodeGraphModel(route.at("graph_model"), routing_settings);
+		}
+
+		if (route.count("integer_weights") && route.at("integer_weights").IsBool()) {
+			routing_settings.integer_weights = route.at("integer_weights").AsBool();
+		}
+
+		if (route.count("route_cache_size") && route.at("route_cache_size").IsInt()) {
+			routing_settings.route_cache_size = std::max(0, route.at("route_cache_size").AsInt());
+		}
+
+		if (route.count("alternatives_max_searches") && route.at("alternatives_max_searches").IsInt()) {
+			routing_settings.alternatives_max_searches = std::max(0, route.at("alternatives_max_searches").AsInt());
+		}
+
+		if (route.count("alternatives_max_milliseconds") && route.at("alternatives_max_milliseconds").IsInt()) {
+			routing_settings.alternatives_max_milliseconds = std::max(0, route.at("alternatives_max_milliseconds").AsInt());
+		}
+
+		if (route.count("bus_headways")) {
+			ParseNodeBusHeadways(route.at("bus_headways"), routing_settings);
 		}
 	}
 
 	else {
-		std::cout << "Failed to parse route settings: it is not a map";
+		std::cerr << "Failed to parse route settings: it is not a map";
+	}
+}
+
+void Reader::ParseNodeRouteOverride(const Node& node, router::RoutingSettingsOverride& routing_settings_override) {
+	if (!node.IsDict()) {
+		std::cerr << "Failed to parse route settings: it is not a map" << std::endl;
+		return;
+	}
+
+	const Dict& route = node.AsDict();
+
+	if (route.count("bus_wait_time")) {
+		const Node& bus_wait_time = route.at("bus_wait_time");
+		if (bus_wait_time.IsDouble() && bus_wait_time.AsDouble() >= 0) {
+			routing_settings_override.bus_wait_time = bus_wait_time.AsDouble();
+		}
+		else {
+			std::cerr << "Failed to parse route settings: bus_wait_time must be a non-negative number" << std::endl;
+		}
+	}
+
+	if (route.count("bus_velocity")) {
+		const Node& bus_velocity = route.at("bus_velocity");
+		if (bus_velocity.IsDouble() && bus_velocity.AsDouble() > 0) {
+			routing_settings_override.bus_velocity = bus_velocity.AsDouble();
+		}
+		else {
+			std::cerr << "Failed to parse route settings: bus_velocity must be a positive number" << std::endl;
+		}
+	}
+}
+
+void Reader::ParseNodeRouterType(const Node& node, router::RoutingSettings& routing_settings) {
+	if (!node.IsString()) {
+		std::cerr << "Failed to parse router type: it is not a string";
+		return;
+	}
+
+	const std::string& router_type = node.AsString();
+
+	if (router_type == "all_pairs") {
+		routing_settings.router_type = RouterType::ALL_PAIRS;
+	}
+	else if (router_type == "dijkstra") {
+		routing_settings.router_type = RouterType::DIJKSTRA;
+	}
+	else if (router_type == "contraction_hierarchy") {
+		routing_settings.router_type = RouterType::CONTRACTION_HIERARCHY;
+	}
+	else if (router_type == "a_star") {
+		routing_settings.router_type = RouterType::A_STAR;
+	}
+	else if (router_type == "bidirectional_dijkstra") {
+		routing_settings.router_type = RouterType::BIDIRECTIONAL_DIJKSTRA;
+	}
+	else if (router_type == "raptor") {
+		routing_settings.router_type = RouterType::RAPTOR;
+	}
+	else {
+		std::cerr << "Failed to parse router type: unknown router " << router_type;
+	}
+}
+
+void Reader::ParseNodeBusHeadways(const Node& node, router::RoutingSettings& routing_settings) {
+	if (!node.IsDict()) {
+		std::cerr << "Failed to parse bus headways: it is not a map";
+		return;
+	}
+
+	for (const auto& [bus_name, headway] : node.AsDict()) {
+		if (!headway.IsDouble() || headway.AsDouble() < 0) {
+			std::cerr << "Failed to parse bus headways: bad headway of bus " << bus_name;
+			continue;
+		}
+		routing_settings.bus_headways[bus_name] = headway.AsDouble();
+	}
+}
+
+void Reader::ParseNodeRoutesTableLayout(const Node& node, router::RoutingSettings& routing_settings) {
+	if (!node.IsString()) {
+		std::cerr << "Failed to parse all-pairs layout: it is not a string";
+		return;
+	}
+
+	const std::string& layout = node.AsString();
+
+	if (layout == "wide") {
+		routing_settings.routes_table_layout = RoutesTableLayout::WIDE;
+	}
+	else if (layout == "compact") {
+		routing_settings.routes_table_layout = RoutesTableLayout::COMPACT;
+	}
+	else {
+		std::cerr << "Failed to parse all-pairs layout: unknown layout " << layout;
+	}
+}
+
+void Reader::ParseNodeGraphModel(const Node& node, router::RoutingSettings& routing_settings) {
+	if (!node.IsString()) {
+		std::cerr << "Failed to parse graph model: it is not a string";
+		return;
+	}
+
+	const std::string& graph_model = node.AsString();
+
+	if (graph_model == "wait_vertices") {
+		routing_settings.graph_model = GraphModel::WAIT_VERTICES;
+	}
+	else if (graph_model == "single_vertex") {
+		routing_settings.graph_model = GraphModel::SINGLE_VERTEX;
+	}
+	else {
+		std::cerr << "Failed to parse graph model: unknown model " << graph_model;
 	}
 }
 
@@ -335,12 +512,12 @@ void Reader::ParseNodeSerialization(const Node& node, serialization::Serializati
 			serialization_settings.file_name = serialization.at("file").AsString();
 		}
 		catch (...) {
-			std::cout << "Failed to parse serialization settings";
+			std::cerr << "Failed to parse serialization settings";
 		}
 	}
 
 	else {
-		std::cout << "Failed to parse serialization settings: it is not a map";
+		std::cerr << "Failed to parse serialization settings: it is not a map";
 	}
 }
 
@@ -406,11 +583,9 @@ Node Reader::MakeMapNode(int id, TransportCatalogue& catalogue, map_renderer::Re
 	return result;
 }
 
-Node Reader::MakeRouteNode(const Stat& stat, TransportCatalogue& catalogue, router::TransportRouter& router) {
-	const auto route_info = router.GetRouteGraphInfo(catalogue.GetStop(stat.from), catalogue.GetStop(stat.to));
-
+Node Reader::MakeRouteNode(int id, const std::optional<RouteGraphInfo>& route_info) {
 	if (!route_info) {
-		return Builder{}.StartDict().Key("request_id").Value(stat.id).Key("error_message").Value("not found").EndDict().Build();
+		return Builder{}.StartDict().Key("request_id").Value(id).Key("error_message").Value("not found").EndDict().Build();
 	}
 
 	Array items;
@@ -418,7 +593,63 @@ Node Reader::MakeRouteNode(const Stat& stat, TransportCatalogue& catalogue, rout
 		items.emplace_back(std::visit(EdgeGetter{}, item));
 	}
 
-	return Builder{}.StartDict().Key("request_id").Value(stat.id).Key("total_time").Value(route_info->total_time).Key("items").Value(items).EndDict().Build();
+	return Builder{}.StartDict().Key("request_id").Value(id).Key("total_time").Value(route_info->total_time).Key("items").Value(items).EndDict().Build();
+}
+
+// The fastest route at the top level as for a plain Route request, all of them ranked under "alternatives"
+Node Reader::MakeAlternativeRoutesNode(int id, const std::vector<RouteGraphInfo>& route_infos) {
+	if (route_infos.empty()) {
+		return MakeRouteNode(id, std::nullopt);
+	}
+
+	Array alternatives;
+	alternatives.reserve(route_infos.size());
+	for (const auto& route_info : route_infos) {
+		Array items;
+		for (const auto& item : route_info.edges) {
+			items.emplace_back(std::visit(EdgeGetter{}, item));
+		}
+		alternatives.emplace_back(Builder{}.StartDict().Key("total_time").Value(route_info.total_time).Key("items").Value(std::move(items)).EndDict().Build());
+	}
+
+	Node result = MakeRouteNode(id, route_infos.front());
+	Dict dict = result.AsDict();
+	dict.emplace("alternatives", std::move(alternatives));
+	return Node(std::move(dict));
+}
+
+Node Reader::MakeIsochroneNode(int id, const std::vector<ReachableStop>& stops) {
+	Array items;
+	items.reserve(stops.size());
+	for (const auto& stop : stops) {
+		items.emplace_back(Builder{}.StartDict().Key("stop_name").Value(std::string(stop.name)).Key("time").Value(stop.time).EndDict().Build());
+	}
+
+	return Builder{}.StartDict().Key("request_id").Value(id).Key("items").Value(std::move(items)).EndDict().Build();
+}
+
+// Plain nested arrays of numbers are assembled in place, null marks a pair without a route
+Node Reader::MakeRouteMatrixNode(int id, const RouteMatrix& route_matrix) {
+	Array rows;
+	rows.reserve(route_matrix.size());
+	for (const auto& weights : route_matrix) {
+		Array row;
+		row.reserve(weights.size());
+		for (const auto& weight : weights) {
+			if (weight) {
+				row.emplace_back(*weight);
+			}
+			else {
+				row.emplace_back(nullptr);
+			}
+		}
+		rows.emplace_back(std::move(row));
+	}
+
+	Dict result;
+	result.emplace("request_id", id);
+	result.emplace("total_times", std::move(rows));
+	return Node(std::move(result));
 }
 
 void Reader::FillMap(map_renderer::MapRenderer& map_renderer, TransportCatalogue& catalogue) const {
@@ -430,11 +661,11 @@ void Reader::FillMap(map_renderer::MapRenderer& map_renderer, TransportCatalogue
 
 	palette_size = map_renderer.GetPaletteSize();
 	if (palette_size == 0u) {
-		std::cout << "Color palette is empty" << std::endl;
+		std::cerr << "Color palette is empty" << std::endl;
 		return;
 	}
 
-	auto buses = catalogue.GetBusesAssociative();
+	const auto& buses = catalogue.GetBusesAssociative();
 	if (buses.size() > 0u) {
 		for (auto bus_name : catalogue.GetSortedBusesNames()) {
 			Bus* bus = catalogue.GetBus(bus_name);
@@ -457,11 +688,11 @@ void Reader::FillMap(map_renderer::MapRenderer& map_renderer, TransportCatalogue
 		}
 	}
 
-	auto stops = catalogue.GetStopsAssociative();
+	const auto& stops = catalogue.GetStopsAssociative();
 	if (stops.size() > 0u) {
 		std::vector<std::string_view> stops_names;
 
-		for (auto& [stop_name, stop] : stops) {
+		for (const auto& [stop_name, stop] : stops) {
 			if (stop->buses.size() > 0u) {
 				stops_names.push_back(stop_name);
 			}
@@ -24,7 +24,7 @@ public:
 public:
 	void ParseQuery(TransportCatalogue& catalogue, std::vector<Stat>& stats, map_renderer::RenderSettings& render_settings, router::RoutingSettings& routing_settings);
 	void ParseNodeMakeBase(TransportCatalogue& catalogue, map_renderer::RenderSettings& render_settings, router::RoutingSettings& routing_settings, serialization::SerializationSettings& serialization_settings);
-	void ParseNodeProcessRequests(std::vector<Stat>& stats, serialization::SerializationSettings& serialization_settings);
+	void ParseNodeProcessRequests(std::vector<Stat>& stats, serialization::SerializationSettings& serialization_settings, router::RoutingSettingsOverride& routing_settings_override);
 
 private:
 	void ParseNode(const Node& root, TransportCatalogue& catalogue, std::vector<Stat>& stats, map_renderer::RenderSettings& render_settings, router::RoutingSettings& routing_settings);
@@ -36,13 +36,21 @@ private:
 	void ParseNodeRenderColor(map_renderer::RenderSettings& render_settings, Dict render_map);
 	void ParseNodeRender(const Node& node, map_renderer::RenderSettings& render_settings);
 	void ParseNodeRoute(const Node& node, router::RoutingSettings& routing_settings);
+	void ParseNodeRouteOverride(const Node& node, router::RoutingSettingsOverride& routing_settings_override);
+	void ParseNodeRouterType(const Node& node, router::RoutingSettings& routing_settings);
+	void ParseNodeRoutesTableLayout(const Node& node, router::RoutingSettings& routing_settings);
+	void ParseNodeGraphModel(const Node& node, router::RoutingSettings& routing_settings);
+	void ParseNodeBusHeadways(const Node& node, router::RoutingSettings& routing_settings);
 	void ParseNodeSerialization(const Node& node, serialization::SerializationSettings& serialization_settings);
 
 public:
 	Node MakeStopNode(int id, StopQuery query);
 	Node MakeBusNode(int id, BusQuery query);
 	Node MakeMapNode(int id, TransportCatalogue& catalogue, map_renderer::RenderSettings& render_settings);
-	Node MakeRouteNode(const Stat& stat, TransportCatalogue& catalogue, router::TransportRouter& router);
+	Node MakeRouteNode(int id, const std::optional<RouteGraphInfo>& route_info);
+	Node MakeAlternativeRoutesNode(int id, const std::vector<RouteGraphInfo>& route_infos);
+	Node MakeRouteMatrixNode(int id, const RouteMatrix& route_matrix);
+	Node MakeIsochroneNode(int id, const std::vector<ReachableStop>& stops);
 
 	void FillMap(map_renderer::MapRenderer& map_renderer, TransportCatalogue& catalogue) const;
 
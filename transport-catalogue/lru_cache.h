@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace cache {
+
+struct CacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t size = 0;
+    size_t capacity = 0;
+};
+
+// Bounded map that evicts the least recently used entry. Every call takes the lock, since a
+// lookup also moves the entry to the front.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache {
+public:
+    explicit LruCache(size_t capacity)
+        : capacity_(capacity) {
+    }
+
+    std::optional<Value> Get(const Key& key) {
+        std::lock_guard guard(mutex_);
+        const auto it = index_.find(key);
+        if (it == index_.end()) {
+            ++misses_;
+            return std::nullopt;
+        }
+        ++hits_;
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return it->second->second;
+    }
+
+    void Put(const Key& key, Value value) {
+        if (capacity_ == 0) {
+            return;
+        }
+
+        std::lock_guard guard(mutex_);
+        if (const auto it = index_.find(key); it != index_.end()) {
+            it->second->second = std::move(value);
+            entries_.splice(entries_.begin(), entries_, it->second);
+            return;
+        }
+
+        if (entries_.size() == capacity_) {
+            index_.erase(entries_.back().first);
+            entries_.pop_back();
+        }
+        entries_.emplace_front(key, std::move(value));
+        index_.emplace(key, entries_.begin());
+    }
+
+    CacheStats GetStats() const {
+        std::lock_guard guard(mutex_);
+        return {hits_, misses_, entries_.size(), capacity_};
+    }
+
+private:
+    using Entries = std::list<std::pair<Key, Value>>;
+
+    const size_t capacity_;
+    // Most recently used first
+    Entries entries_;
+    std::unordered_map<Key, typename Entries::iterator, Hash> index_;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+    mutable std::mutex mutex_;
+};
+
+}  // namespace cache
@@ -1,4 +1,5 @@
-﻿#include <fstream>
+﻿#include <chrono>
+#include <fstream>
 #include <iostream>
 
 #include "json_reader.h"
@@ -15,16 +16,18 @@ using namespace request_handler;
 using namespace serialization;
 
 void PrintUsage(std::ostream& stream = std::cerr) {
-    stream << "Usage: transport_catalogue [make_base|process_requests]\n"sv;
+    stream << "Usage: transport_catalogue [make_base|process_requests] [--stats]\n"sv;
 }
 
 int main(int argc, char* argv[]) {
-    if (argc != 2) {
+    if (argc != 2 && !(argc == 3 && argv[2] == "--stats"sv)) {
         PrintUsage();
         return 1;
     }
 
     const std::string_view mode(argv[1]);
+    // Diagnostics go to stderr so that the JSON answer on stdout stays intact
+    std::ostream* stats_output = argc == 3 ? &cerr : nullptr;
 
     TransportCatalogue catalogue;
 
@@ -41,25 +44,65 @@ int main(int argc, char* argv[]) {
 
     if (mode == "make_base"sv) {
 
+        auto start = chrono::steady_clock::now();
         reader = Reader(cin);
         reader.ParseNodeMakeBase(catalogue, render_settings, routing_settings, serialization_settings);
+        if (stats_output) {
+            PrintPhaseDuration(*stats_output, "parse"sv, start);
+        }
+
+        // The router is built once here and stored in the base together with its preprocessing
+        start = chrono::steady_clock::now();
+        TransportRouter router(catalogue, routing_settings);
+        if (stats_output) {
+            PrintPhaseDuration(*stats_output, "router build"sv, start);
+            router.PrintStats(*stats_output);
+        }
+
+        start = chrono::steady_clock::now();
         ofstream out_file(serialization_settings.file_name, ios::binary);
-        SerializeTransportCatalogueUnion(catalogue, render_settings, routing_settings, out_file);
+        SerializeTransportCatalogueUnion(catalogue, render_settings, routing_settings, &router, out_file);
+        if (stats_output) {
+            PrintPhaseDuration(*stats_output, "serialize"sv, start);
+        }
 
     } 
 
     else if (mode == "process_requests"sv) {
 
+        auto start = chrono::steady_clock::now();
         reader = Reader(cin);
 
-        reader.ParseNodeProcessRequests(stats, serialization_settings);
+        RoutingSettingsOverride routing_settings_override;
+        reader.ParseNodeProcessRequests(stats, serialization_settings, routing_settings_override);
+        if (stats_output) {
+            PrintPhaseDuration(*stats_output, "parse"sv, start);
+        }
 
+        start = chrono::steady_clock::now();
         ifstream in_file(serialization_settings.file_name, ios::binary);
-        TransportCatalogueUnion catalogue_union = DeserializeTransportCatalogueUnion(in_file);
-
-        RequestHandler request_handler;
-
-        Print(request_handler.HandleRequest(catalogue_union.transport_catalogue_, stats, catalogue_union.render_settings_, catalogue_union.routing_settings_), cout); 
+        TransportCatalogueUnion catalogue_union = DeserializeTransportCatalogueUnion(in_file, HasRouteRequests(stats));
+        if (stats_output) {
+            PrintPhaseDuration(*stats_output, "deserialize"sv, start);
+        }
+
+        // Only the weights may be re-tuned without make_base, the graph and the engine come from the base
+        if (routing_settings_override.bus_wait_time) {
+            catalogue_union.routing_settings_.bus_wait_time = *routing_settings_override.bus_wait_time;
+        }
+        if (routing_settings_override.bus_velocity) {
+            catalogue_union.routing_settings_.bus_velocity = *routing_settings_override.bus_velocity;
+        }
+
+        start = chrono::steady_clock::now();
+        RequestHandler request_handler(stats_output);
+
+        Document answer = request_handler.HandleRequest(catalogue_union.transport_catalogue_, stats, catalogue_union.render_settings_, catalogue_union.routing_settings_, std::move(catalogue_union.router_data_));
+        if (stats_output) {
+            PrintPhaseDuration(*stats_output, "requests"sv, start);
+        }
+
+        Print(answer, cout); 
 
     } else {
         PrintUsage();
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GRAPH_MIN_PLUS_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace graph {
+
+namespace detail {
+
+// Min-plus update of one row of the all-pairs table through one intermediate vertex:
+// for every j, if weight_from + through_weights[j] < weights[j] the route is replaced,
+// and its last edge becomes through_prev_edges[j] (or prev_edge_from if that is no_edge).
+template <typename Weight, typename EdgeIdType>
+void RelaxRowScalar(const Weight* through_weights, const EdgeIdType* through_prev_edges,
+                    Weight weight_from, EdgeIdType prev_edge_from,
+                    Weight* weights, EdgeIdType* prev_edges, size_t count,
+                    Weight infinite_weight, EdgeIdType no_edge) {
+    for (size_t j = 0; j < count; ++j) {
+        if constexpr (!std::numeric_limits<Weight>::has_infinity) {
+            if (through_weights[j] == infinite_weight) {
+                continue;
+            }
+        }
+        const Weight candidate_weight = weight_from + through_weights[j];
+        if (candidate_weight < weights[j]) {
+            weights[j] = candidate_weight;
+            prev_edges[j] = through_prev_edges[j] != no_edge ? through_prev_edges[j] : prev_edge_from;
+        }
+    }
+}
+
+#ifdef GRAPH_MIN_PLUS_AVX2
+
+inline bool HasAvx2() {
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    return has_avx2;
+}
+
+// Four doubles per step, their 32-bit edge ids are blended with the comparison mask narrowed to 32-bit lanes
+__attribute__((target("avx2"))) inline size_t RelaxRowAvx2(const double* through_weights, const uint32_t* through_prev_edges,
+                                                           double weight_from, uint32_t prev_edge_from,
+                                                           double* weights, uint32_t* prev_edges, size_t count,
+                                                           uint32_t no_edge) {
+    const __m256d from = _mm256_set1_pd(weight_from);
+    const __m128i from_edge = _mm_set1_epi32(static_cast<int>(prev_edge_from));
+    const __m128i missing_edge = _mm_set1_epi32(static_cast<int>(no_edge));
+    const __m256i even_lanes = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+
+    size_t j = 0;
+    for (; j + 4 <= count; j += 4) {
+        const __m256d candidate = _mm256_add_pd(from, _mm256_loadu_pd(through_weights + j));
+        const __m256d current = _mm256_loadu_pd(weights + j);
+        const __m256d better = _mm256_cmp_pd(candidate, current, _CMP_LT_OQ);
+        if (_mm256_movemask_pd(better) == 0) {
+            continue;
+        }
+        _mm256_storeu_pd(weights + j, _mm256_blendv_pd(current, candidate, better));
+
+        const __m128i better_lanes = _mm256_castsi256_si128(
+            _mm256_permutevar8x32_epi32(_mm256_castpd_si256(better), even_lanes));
+        const __m128i through_edge = _mm_loadu_si128(reinterpret_cast<const __m128i*>(through_prev_edges + j));
+        const __m128i new_edge = _mm_blendv_epi8(through_edge, from_edge, _mm_cmpeq_epi32(through_edge, missing_edge));
+        const __m128i current_edge = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_edges + j));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(prev_edges + j), _mm_blendv_epi8(current_edge, new_edge, better_lanes));
+    }
+    return j;
+}
+
+// Eight floats per step, the comparison mask already has the width of the edge ids
+__attribute__((target("avx2"))) inline size_t RelaxRowAvx2(const float* through_weights, const uint32_t* through_prev_edges,
+                                                           float weight_from, uint32_t prev_edge_from,
+                                                           float* weights, uint32_t* prev_edges, size_t count,
+                                                           uint32_t no_edge) {
+    const __m256 from = _mm256_set1_ps(weight_from);
+    const __m256i from_edge = _mm256_set1_epi32(static_cast<int>(prev_edge_from));
+    const __m256i missing_edge = _mm256_set1_epi32(static_cast<int>(no_edge));
+
+    size_t j = 0;
+    for (; j + 8 <= count; j += 8) {
+        const __m256 candidate = _mm256_add_ps(from, _mm256_loadu_ps(through_weights + j));
+        const __m256 current = _mm256_loadu_ps(weights + j);
+        const __m256 better = _mm256_cmp_ps(candidate, current, _CMP_LT_OQ);
+        if (_mm256_movemask_ps(better) == 0) {
+            continue;
+        }
+        _mm256_storeu_ps(weights + j, _mm256_blendv_ps(current, candidate, better));
+
+        const __m256i through_edge = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(through_prev_edges + j));
+        const __m256i new_edge = _mm256_blendv_epi8(through_edge, from_edge, _mm256_cmpeq_epi32(through_edge, missing_edge));
+        const __m256i current_edge = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev_edges + j));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(prev_edges + j),
+                            _mm256_blendv_epi8(current_edge, new_edge, _mm256_castps_si256(better)));
+    }
+    return j;
+}
+
+#endif
+
+// Uses the AVX2 kernel when the weights are double or float with 32-bit edge ids and the CPU
+// supports it; the remainder of the row and every other case go through the scalar loop
+template <typename Weight, typename EdgeIdType>
+void RelaxRow(const Weight* through_weights, const EdgeIdType* through_prev_edges,
+              Weight weight_from, EdgeIdType prev_edge_from,
+              Weight* weights, EdgeIdType* prev_edges, size_t count,
+              Weight infinite_weight, EdgeIdType no_edge, bool allow_simd = true) {
+    size_t done = 0;
+#ifdef GRAPH_MIN_PLUS_AVX2
+    if constexpr ((std::is_same_v<Weight, double> || std::is_same_v<Weight, float>) && std::is_same_v<EdgeIdType, uint32_t>) {
+        if (allow_simd && HasAvx2()) {
+            done = RelaxRowAvx2(through_weights, through_prev_edges, weight_from, prev_edge_from,
+                                weights, prev_edges, count, no_edge);
+        }
+    }
+#endif
+    RelaxRowScalar(through_weights + done, through_prev_edges + done, weight_from, prev_edge_from,
+                   weights + done, prev_edges + done, count - done, infinite_weight, no_edge);
+}
+
+}  // namespace detail
+
+}  // namespace graph
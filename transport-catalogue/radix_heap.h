@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace graph {
+
+// Monotone priority queue for unsigned integer keys, as needed by Dijkstra: a pushed key may
+// not be smaller than the last popped one. Items are kept in buckets by the highest bit in which
+// their key differs from the last popped key, so push is O(1) and every item is moved between
+// buckets at most once per bit of the key.
+template <typename Item, typename KeyOf>
+class RadixHeap {
+private:
+    using Key = std::decay_t<decltype(KeyOf{}(std::declval<const Item&>()))>;
+    static_assert(std::is_unsigned_v<Key>, "Radix heap keys should be unsigned integers");
+
+    static constexpr size_t BUCKET_COUNT = std::numeric_limits<Key>::digits + 1;
+
+public:
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    void push(const Item& item) {
+        const Key key = KeyOf{}(item);
+        if (key < last_key_) {
+            throw std::invalid_argument("Radix heap keys should not decrease");
+        }
+        buckets_[GetBucket(key)].push_back(item);
+        ++size_;
+    }
+
+    const Item& top() {
+        if (buckets_[0].empty()) {
+            Redistribute();
+        }
+        return buckets_[0].back();
+    }
+
+    void pop() {
+        top();
+        buckets_[0].pop_back();
+        --size_;
+    }
+
+private:
+    // Number of significant bits in which key differs from the last popped key
+    size_t GetBucket(Key key) const {
+        Key difference = key ^ last_key_;
+        size_t bucket = 0;
+        while (difference != 0) {
+            ++bucket;
+            difference >>= 1;
+        }
+        return bucket;
+    }
+
+    // Moves the smallest key of the first non-empty bucket into last_key_ and spreads that
+    // bucket over lower ones; its minimum lands in bucket 0
+    void Redistribute() {
+        size_t bucket = 1;
+        while (buckets_[bucket].empty()) {
+            ++bucket;
+        }
+
+        std::vector<Item> items = std::move(buckets_[bucket]);
+        buckets_[bucket].clear();
+
+        Key min_key = KeyOf{}(items.front());
+        for (const Item& item : items) {
+            const Key key = KeyOf{}(item);
+            if (key < min_key) {
+                min_key = key;
+            }
+        }
+        last_key_ = min_key;
+
+        for (Item& item : items) {
+            buckets_[GetBucket(KeyOf{}(item))].push_back(std::move(item));
+        }
+    }
+
+    std::array<std::vector<Item>, BUCKET_COUNT> buckets_;
+    Key last_key_ = 0;
+    size_t size_ = 0;
+};
+
+}  // namespace graph
@@ -0,0 +1,209 @@
+#include "raptor_router.h"
+
+#include <algorithm>
+
+namespace transport_catalogue {
+
+namespace detail {
+
+namespace router {
+
+RaptorRouter::RaptorRouter(const TransportCatalogue& catalogue, const RoutingSettings& routing_settings)
+	: bus_velocity_(routing_settings.bus_velocity) {
+	const size_t stop_count = catalogue.GetStopCount();
+	stop_names_.resize(stop_count);
+	for (size_t stop_id = 0; stop_id < stop_count; ++stop_id) {
+		stop_names_[stop_id] = catalogue.GetStopById(stop_id)->name;
+	}
+
+	std::vector<const Bus*> buses;
+	for (const auto& [_, bus] : catalogue.GetBusesAssociative()) {
+		buses.push_back(bus);
+	}
+	std::sort(buses.begin(), buses.end(), [](const Bus* lhs, const Bus* rhs) {
+		return lhs->name < rhs->name;
+	});
+
+	for (const Bus* bus : buses) {
+		AddRoute(bus->stops.begin(), bus->stops.end(), bus, catalogue);
+		if (!bus->is_roundtrip) {
+			AddRoute(bus->stops.rbegin(), bus->stops.rend(), bus, catalogue);
+		}
+	}
+
+	for (Route& route : routes_) {
+		const auto headway = routing_settings.bus_headways.find(std::string(route.bus_name));
+		route.wait_time = headway != routing_settings.bus_headways.end() ? headway->second : routing_settings.bus_wait_time;
+	}
+
+	stop_routes_offsets_.assign(stop_count + 1, 0);
+	for (const size_t stop_id : route_stops_) {
+		++stop_routes_offsets_[stop_id + 1];
+	}
+	for (size_t stop_id = 0; stop_id < stop_count; ++stop_id) {
+		stop_routes_offsets_[stop_id + 1] += stop_routes_offsets_[stop_id];
+	}
+	stop_routes_.resize(route_stops_.size());
+	std::vector<size_t> positions(stop_routes_offsets_.begin(), stop_routes_offsets_.end() - 1);
+	for (size_t route_id = 0; route_id < routes_.size(); ++route_id) {
+		const Route& route = routes_[route_id];
+		for (size_t position = 0; position < route.stop_count; ++position) {
+			stop_routes_[positions[route_stops_[route.begin + position]]++] = { route_id, position };
+		}
+	}
+}
+
+RaptorRouter::Labels RaptorRouter::Search(size_t from, std::optional<size_t> to, std::optional<double> max_time,
+	std::optional<size_t> max_rides) const {
+	const size_t stop_count = stop_names_.size();
+	Labels labels{ from, { std::vector<Label>(stop_count) } };
+	labels.rounds[0][from].time = 0;
+
+	std::vector<double> best_times(stop_count, std::numeric_limits<double>::infinity());
+	best_times[from] = 0;
+	std::vector<size_t> marked_stops{ from };
+	std::vector<bool> is_marked(stop_count, false);
+	is_marked[from] = true;
+
+	// Earliest position of every route at a stop marked in the previous round
+	std::vector<size_t> start_positions(routes_.size(), NO_ROUTE);
+	std::vector<size_t> queued_routes;
+
+	while (!marked_stops.empty() && (!max_rides || labels.rounds.size() <= *max_rides)) {
+		for (const size_t stop_id : marked_stops) {
+			is_marked[stop_id] = false;
+			for (size_t index = stop_routes_offsets_[stop_id]; index < stop_routes_offsets_[stop_id + 1]; ++index) {
+				const auto [route_id, position] = stop_routes_[index];
+				if (start_positions[route_id] == NO_ROUTE) {
+					queued_routes.push_back(route_id);
+					start_positions[route_id] = position;
+				}
+				else {
+					start_positions[route_id] = std::min(start_positions[route_id], position);
+				}
+			}
+		}
+		marked_stops.clear();
+
+		std::vector<Label> current(stop_count);
+		for (size_t stop_id = 0; stop_id < stop_count; ++stop_id) {
+			current[stop_id].time = labels.rounds.back()[stop_id].time;
+		}
+
+		for (const size_t route_id : queued_routes) {
+			ScanRoute(route_id, start_positions[route_id], to, max_time, labels.rounds.back(), current, best_times, marked_stops, is_marked);
+			start_positions[route_id] = NO_ROUTE;
+		}
+		queued_routes.clear();
+
+		labels.rounds.push_back(std::move(current));
+	}
+
+	return labels;
+}
+
+void RaptorRouter::ScanRoute(size_t route_id, size_t start_position, std::optional<size_t> to, std::optional<double> max_time,
+	const std::vector<Label>& previous, std::vector<Label>& current,
+	std::vector<double>& best_times, std::vector<size_t>& marked_stops, std::vector<bool>& is_marked) const {
+	const Route& route = routes_[route_id];
+	std::optional<size_t> board_position;
+	double board_time = 0;
+
+	for (size_t position = start_position; position < route.stop_count; ++position) {
+		const size_t stop_id = route_stops_[route.begin + position];
+
+		if (board_position) {
+			const double arrival_time = board_time + route.wait_time + ComputeRideTime(route, *board_position, position);
+			const double bound = to ? std::min(best_times[stop_id], best_times[*to]) : best_times[stop_id];
+			if (arrival_time < bound && (!max_time || arrival_time <= *max_time)) {
+				current[stop_id] = { arrival_time, route_id, *board_position, position };
+				best_times[stop_id] = arrival_time;
+				if (!is_marked[stop_id]) {
+					is_marked[stop_id] = true;
+					marked_stops.push_back(stop_id);
+				}
+			}
+		}
+
+		// Boarding here is better when the rider reaches the stop before the bus boarded earlier does
+		const double previous_time = previous[stop_id].time;
+		if (previous_time < std::numeric_limits<double>::infinity()
+			&& (!board_position || previous_time < board_time + ComputeRideTime(route, *board_position, position))) {
+			board_position = position;
+			board_time = previous_time;
+		}
+	}
+}
+
+double RaptorRouter::ComputeRideTime(const Route& route, size_t board_position, size_t alight_position) const {
+	const double distance = route_distances_[route.begin + alight_position] - route_distances_[route.begin + board_position];
+	return distance * 1.0 / (bus_velocity_ * 1000 / 60);
+}
+
+std::optional<double> RaptorRouter::GetArrivalTime(const Labels& labels, size_t to) const {
+	// Times never grow from round to round, the last one holds the best
+	const double time = labels.rounds.back().at(to).time;
+	if (time == std::numeric_limits<double>::infinity()) {
+		return std::nullopt;
+	}
+	return time;
+}
+
+std::optional<RouteGraphInfo> RaptorRouter::BuildRoute(const Labels& labels, size_t to) const {
+	const auto time = GetArrivalTime(labels, to);
+	if (!time) {
+		return std::nullopt;
+	}
+
+	size_t round = 0;
+	while (labels.rounds[round][to].time != *time) {
+		++round;
+	}
+
+	std::vector<Label> rides;
+	for (size_t stop_id = to; round > 0; --round) {
+		const Label& label = labels.rounds[round][stop_id];
+		if (label.route == NO_ROUTE) {
+			continue;
+		}
+		rides.push_back(label);
+		stop_id = route_stops_[routes_[label.route].begin + label.board_position];
+	}
+	std::reverse(rides.begin(), rides.end());
+
+	RouteGraphInfo result;
+	result.total_time = *time;
+	for (const Label& ride : rides) {
+		const Route& route = routes_[ride.route];
+		const size_t board_stop = route_stops_[route.begin + ride.board_position];
+		const size_t distance = route_distances_[route.begin + ride.alight_position] - route_distances_[route.begin + ride.board_position];
+		result.edges.emplace_back(StopEdge{ stop_names_[board_stop], route.wait_time });
+		result.edges.emplace_back(BusEdge{ route.bus_name, ride.alight_position - ride.board_position,
+			ComputeRideTime(route, ride.board_position, ride.alight_position), distance });
+	}
+	return result;
+}
+
+graph::DirectedWeightedGraph<double> RaptorRouter::MakeStopGraph() const {
+	graph::DirectedWeightedGraph<double> stop_graph(stop_names_.size());
+	for (const Route& route : routes_) {
+		for (size_t position = 1; position < route.stop_count; ++position) {
+			stop_graph.AddEdge({ route_stops_[route.begin + position - 1], route_stops_[route.begin + position], 0.0 });
+		}
+	}
+	return stop_graph;
+}
+
+size_t RaptorRouter::GetRouteCount() const {
+	return routes_.size();
+}
+
+size_t RaptorRouter::GetRouteStopCount() const {
+	return route_stops_.size();
+}
+
+} // namespace router
+
+} // namespace detail
+
+} // namespace transport_catalogue
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "domain.h"
+#include "transport_catalogue.h"
+
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace transport_catalogue {
+
+namespace detail {
+
+namespace router {
+
+using namespace domain;
+
+// Round-based router (RAPTOR) working on the stop sequences of buses instead of the graph.
+// Round k finds the earliest arrivals with k rides, scanning in order the stops of every bus
+// direction that serves a stop improved in round k - 1. Boarding waits bus_wait_time like on the
+// graph, so without bus_headways the engines give the same times. A bus listed in bus_headways
+// is waited for a full headway instead: the rider is assumed to just miss it, the same
+// worst case bus_wait_time stands for.
+class RaptorRouter {
+public:
+	static constexpr size_t NO_ROUTE = std::numeric_limits<size_t>::max();
+
+	// Arrival at a stop in one round, with the ride that led there. Stops not improved in the
+	// round keep the time of the previous one and have no ride.
+	struct Label {
+		double time = std::numeric_limits<double>::infinity();
+		size_t route = NO_ROUTE;
+		size_t board_position = 0;
+		size_t alight_position = 0;
+	};
+
+	// Labels of every stop after every round, indexed by round and Stop::id
+	struct Labels {
+		size_t from = 0;
+		std::vector<std::vector<Label>> rounds;
+	};
+
+	RaptorRouter(const TransportCatalogue& catalogue, const RoutingSettings& routing_settings);
+
+	// With a target the search stops improving stops that can not beat it. With max_time it
+	// drops arrivals later than that, with max_rides it stops after that many rounds.
+	Labels Search(size_t from, std::optional<size_t> to = std::nullopt, std::optional<double> max_time = std::nullopt,
+		std::optional<size_t> max_rides = std::nullopt) const;
+	std::optional<double> GetArrivalTime(const Labels& labels, size_t to) const;
+	// The fastest route to `to`, with the fewest rides among equally fast ones
+	std::optional<RouteGraphInfo> BuildRoute(const Labels& labels, size_t to) const;
+
+	// Stops joined along every bus direction, it has the reachability of the routing graph
+	graph::DirectedWeightedGraph<double> MakeStopGraph() const;
+
+	size_t GetRouteCount() const;
+	size_t GetRouteStopCount() const;
+
+private:
+	// One direction of a bus: a contiguous range of route_stops_
+	struct Route {
+		std::string_view bus_name;
+		double wait_time = 0;
+		size_t begin = 0;
+		size_t stop_count = 0;
+	};
+
+	template <typename Iterator>
+	void AddRoute(Iterator first, Iterator last, const Bus* bus, const TransportCatalogue& catalogue);
+	void ScanRoute(size_t route_id, size_t start_position, std::optional<size_t> to, std::optional<double> max_time,
+		const std::vector<Label>& previous, std::vector<Label>& current,
+		std::vector<double>& best_times, std::vector<size_t>& marked_stops, std::vector<bool>& is_marked) const;
+	double ComputeRideTime(const Route& route, size_t board_position, size_t alight_position) const;
+
+	double bus_velocity_ = 0;
+	std::vector<std::string_view> stop_names_;
+
+	std::vector<Route> routes_;
+	// Stop ids of all routes back to back, and the road distance from the first stop of the route
+	std::vector<size_t> route_stops_;
+	std::vector<size_t> route_distances_;
+
+	// Routes through every stop as (route, position in it), grouped by Stop::id
+	std::vector<size_t> stop_routes_offsets_;
+	std::vector<std::pair<size_t, size_t>> stop_routes_;
+};
+
+template <typename Iterator>
+void RaptorRouter::AddRoute(Iterator first, Iterator last, const Bus* bus, const TransportCatalogue& catalogue) {
+	Route route{ bus->name, 0, route_stops_.size(), 0 };
+	size_t distance = 0;
+	for (auto it = first; it != last; ++it) {
+		if (it != first) {
+			distance += catalogue.GetDistanceBetweenStops(*std::prev(it), *it);
+		}
+		route_stops_.push_back((*it)->id);
+		route_distances_.push_back(distance);
+		++route.stop_count;
+	}
+	routes_.push_back(route);
+}
+
+} // namespace router
+
+} // namespace detail
+
+} // namespace transport_catalogue
@@ -1,15 +1,54 @@
 #include "request_handler.h"
 
 using namespace std::string_literals;
+using namespace std::string_view_literals;
 
 namespace request_handler {
 
-Document RequestHandler::HandleRequest(TransportCatalogue& catalogue, std::vector<Stat>& stats, RenderSettings& render_settings, RoutingSettings& routing_settings) {
+void PrintPhaseDuration(std::ostream& output, std::string_view phase, std::chrono::steady_clock::time_point start) {
+	const auto duration = std::chrono::steady_clock::now() - start;
+	output << "Phase "s << phase << ": "s << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << " ms\n"s;
+}
+
+bool HasRouteRequests(const std::vector<Stat>& stats) {
+	return std::any_of(stats.begin(), stats.end(), [](const Stat& stat) {
+		return stat.type == "Route" || stat.type == "RouteMatrix" || stat.type == "Isochrone";
+	});
+}
+
+RequestHandler::RequestHandler(std::ostream* stats_output)
+	: stats_output_(stats_output) {
+}
+
+Document RequestHandler::HandleRequest(TransportCatalogue& catalogue, std::vector<Stat>& stats, RenderSettings& render_settings, RoutingSettings& routing_settings, std::optional<TransportRouterData> router_data) {
 	std::vector<Node> result;
 
-	router::TransportRouter router(catalogue, routing_settings);
+	// The router is built on the first Route request only, batches without one skip it entirely
+	std::optional<router::TransportRouter> router;
+	auto get_router = [&]() -> router::TransportRouter& {
+		if (!router) {
+			const auto start = std::chrono::steady_clock::now();
+			if (router_data) {
+				router.emplace(catalogue, routing_settings, std::move(*router_data));
+			}
+			else {
+				router.emplace(catalogue, routing_settings);
+			}
+			if (stats_output_) {
+				PrintPhaseDuration(*stats_output_, "router build"sv, start);
+				router->PrintStats(*stats_output_);
+			}
+		}
+		return *router;
+	};
 
-	for (const auto& stat : stats) {
+	std::vector<std::optional<RouteGraphInfo>> route_infos;
+	if (std::any_of(stats.begin(), stats.end(), [](const Stat& stat) { return stat.type == "Route" && !stat.max_transfers && !stat.alternatives; })) {
+		route_infos = BuildRoutesByOrigin(catalogue, stats, get_router());
+	}
+
+	for (size_t index = 0; index < stats.size(); ++index) {
+		const Stat& stat = stats[index];
 		if (stat.type == "Stop") {
 			result.push_back(reader_.MakeStopNode(stat.id, catalogue.GetStopQuery(stat.name)));
 		}
@@ -19,12 +58,94 @@ Document RequestHandler::HandleRequest(TransportCatalogue& catalogue, std::vecto
 		else if (stat.type == "Map") {
 			result.push_back(reader_.MakeMapNode(stat.id, catalogue, render_settings));
 		}
+		else if (stat.type == "Route" && stat.alternatives) {
+			result.push_back(reader_.MakeAlternativeRoutesNode(stat.id, get_router().GetAlternativeRouteGraphInfos(catalogue.GetStop(stat.from), catalogue.GetStop(stat.to), *stat.alternatives)));
+		}
+		else if (stat.type == "Route" && stat.max_transfers) {
+			result.push_back(reader_.MakeRouteNode(stat.id, get_router().GetLimitedRouteGraphInfo(catalogue.GetStop(stat.from), catalogue.GetStop(stat.to), *stat.max_transfers)));
+		}
 		else if (stat.type == "Route") {
-			result.push_back(reader_.MakeRouteNode(stat, catalogue, router));
+			result.push_back(reader_.MakeRouteNode(stat.id, route_infos[index]));
+		}
+		else if (stat.type == "Isochrone") {
+			result.push_back(reader_.MakeIsochroneNode(stat.id, GetReachableStops(catalogue, stat, get_router())));
+		}
+		else if (stat.type == "RouteMatrix") {
+			result.push_back(reader_.MakeRouteMatrixNode(stat.id, get_router().GetRouteMatrix(GetStops(catalogue, stat.from_stops), GetStops(catalogue, stat.to_stops))));
+		}
+	}
+
+	if (!router && stats_output_) {
+		*stats_output_ << "Phase router build: skipped, no Route requests\n";
+	}
+	if (router && stats_output_) {
+		if (const auto cache_stats = router->GetRouteCacheStats()) {
+			*stats_output_ << "Route cache: " << cache_stats->hits << " hits, " << cache_stats->misses << " misses, "
+				<< cache_stats->size << " of " << cache_stats->capacity << " entries\n";
 		}
 	}
 
 	return Document{ Node(result) };
 }
 
+// Nearest stops first, ties by name
+std::vector<ReachableStop> RequestHandler::GetReachableStops(TransportCatalogue& catalogue, const Stat& stat, const router::TransportRouter& router) const {
+	std::vector<ReachableStop> result;
+	for (const auto& [stop_id, time] : router.GetIsochrone(catalogue.GetStop(stat.from), stat.max_time)) {
+		result.push_back({ catalogue.GetStopById(stop_id)->name, time });
+	}
+
+	std::sort(result.begin(), result.end(), [](const ReachableStop& lhs, const ReachableStop& rhs) {
+		return std::tie(lhs.time, lhs.name) < std::tie(rhs.time, rhs.name);
+	});
+	return result;
+}
+
+std::vector<const Stop*> RequestHandler::GetStops(TransportCatalogue& catalogue, const std::vector<std::string>& names) const {
+	std::vector<const Stop*> result;
+	result.reserve(names.size());
+	for (const auto& name : names) {
+		result.push_back(catalogue.GetStop(name));
+	}
+	return result;
+}
+
+std::vector<std::optional<RouteGraphInfo>> RequestHandler::BuildRoutesByOrigin(TransportCatalogue& catalogue, const std::vector<Stat>& stats, const router::TransportRouter& router) const {
+	std::vector<const Stop*> origins;
+	std::unordered_map<const Stop*, std::vector<size_t>> requests_by_origin;
+	for (size_t index = 0; index < stats.size(); ++index) {
+		if (stats[index].type != "Route" || stats[index].max_transfers || stats[index].alternatives) {
+			continue;
+		}
+		// Stats with an unknown stop keep an empty answer, printed as not found
+		const Stop* from = catalogue.GetStop(stats[index].from);
+		if (!from || !catalogue.GetStop(stats[index].to)) {
+			continue;
+		}
+		auto& requests = requests_by_origin[from];
+		if (requests.empty()) {
+			origins.push_back(from);
+		}
+		requests.push_back(index);
+	}
+
+	std::vector<std::optional<RouteGraphInfo>> result(stats.size());
+	for (const Stop* from : origins) {
+		const auto& requests = requests_by_origin.at(from);
+
+		std::vector<const Stop*> destinations;
+		destinations.reserve(requests.size());
+		for (const size_t index : requests) {
+			destinations.push_back(catalogue.GetStop(stats[index].to));
+		}
+
+		auto route_infos = router.GetRouteGraphInfos(from, destinations);
+		for (size_t i = 0; i < requests.size(); ++i) {
+			result[requests[i]] = std::move(route_infos[i]);
+		}
+	}
+
+	return result;
+}
+
 } // namespace request_handler
\ No newline at end of file
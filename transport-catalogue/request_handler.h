@@ -6,7 +6,14 @@
 #include "transport_catalogue.h"
 #include "transport_router.h"
 
+#include <algorithm>
+#include <chrono>
+#include <optional>
 #include <sstream>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
 
 using namespace transport_catalogue;
 using namespace transport_catalogue::detail::json;
@@ -15,14 +22,27 @@ using namespace router;
 
 namespace request_handler {
 
+// Diagnostics for --stats: how long a phase has been running since start
+void PrintPhaseDuration(std::ostream& output, std::string_view phase, std::chrono::steady_clock::time_point start);
+
+bool HasRouteRequests(const std::vector<Stat>& stats);
+
 class RequestHandler {
 public:
 	RequestHandler() = default;
+	explicit RequestHandler(std::ostream* stats_output);
 
-	Document HandleRequest(TransportCatalogue& catalogue, std::vector<Stat>& stats, RenderSettings& render_settings, RoutingSettings& routing_settings);
+	Document HandleRequest(TransportCatalogue& catalogue, std::vector<Stat>& stats, RenderSettings& render_settings, RoutingSettings& routing_settings, std::optional<TransportRouterData> router_data = std::nullopt);
 
 private:
+	// Route answers in the order of stats (empty for other requests), one search per origin stop
+	std::vector<std::optional<RouteGraphInfo>> BuildRoutesByOrigin(TransportCatalogue& catalogue, const std::vector<Stat>& stats, const router::TransportRouter& router) const;
+
+	std::vector<ReachableStop> GetReachableStops(TransportCatalogue& catalogue, const Stat& stat, const router::TransportRouter& router) const;
+	std::vector<const Stop*> GetStops(TransportCatalogue& catalogue, const std::vector<std::string>& names) const;
+
 	Reader reader_;
+	std::ostream* stats_output_ = nullptr;
 };
 
 } // namespace request_handler
\ No newline at end of file
@@ -1,126 +1,307 @@
 #pragma once
 
 #include "graph.h"
+#include "min_plus_kernel.h"
 
 #include <algorithm>
 #include <cassert>
+#include <condition_variable>
 #include <cstdint>
 #include <iterator>
+#include <limits>
+#include <mutex>
 #include <optional>
 #include <stdexcept>
-#include <unordered_map>
+#include <thread>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 namespace graph {
 
-template <typename Weight>
+namespace detail {
+
+// Reusable barrier: Wait returns once every one of the count threads has reached it
+class Barrier {
+public:
+    explicit Barrier(size_t count)
+        : count_(count) {
+    }
+
+    void Wait() {
+        std::unique_lock lock(mutex_);
+        const size_t generation = generation_;
+        if (++waiting_ == count_) {
+            waiting_ = 0;
+            ++generation_;
+            condition_.notify_all();
+        }
+        else {
+            condition_.wait(lock, [this, generation] {
+                return generation != generation_;
+            });
+        }
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    size_t count_ = 0;
+    size_t waiting_ = 0;
+    size_t generation_ = 0;
+};
+
+}  // namespace detail
+
+// All-pairs router. TableWeight is the type the table stores weights in: a narrower type
+// (float for double graphs) halves the table, while route weights are still summed up
+// from the graph edges in Weight precision.
+template <typename Weight, typename TableWeight = Weight>
 class Router {
 private:
     using Graph = DirectedWeightedGraph<Weight>;
+    using TableEdgeId = uint32_t;
 
 public:
-    explicit Router(const Graph& graph);
+    using RouteInfo = graph::RouteInfo<Weight>;
 
-    struct RouteInfo {
-        Weight weight;
-        std::vector<EdgeId> edges;
+    static constexpr TableWeight INFINITE_WEIGHT = std::numeric_limits<TableWeight>::has_infinity
+        ? std::numeric_limits<TableWeight>::infinity()
+        : std::numeric_limits<TableWeight>::max();
+    static constexpr TableEdgeId NO_EDGE = std::numeric_limits<TableEdgeId>::max();
+
+    // Row-major vertex_count x vertex_count structure-of-arrays table of shortest routes.
+    // Missing routes have INFINITE_WEIGHT, routes without a last edge (from a vertex
+    // to itself) have NO_EDGE.
+    struct RoutesInternalData {
+        size_t vertex_count = 0;
+        std::vector<TableWeight> weights;
+        std::vector<TableEdgeId> prev_edges;
     };
 
+    explicit Router(const Graph& graph, size_t thread_count = 1);
+    Router(const Graph& graph, RoutesInternalData routes_internal_data);
+
+    // Lets the scalar relaxation be forced, e.g. to compare it with the vectorized one
+    void SetSimdEnabled(bool use_simd) {
+        use_simd_ = use_simd;
+    }
+
     void Build() {
         InitializeRoutesInternalData(graph_);
-        const size_t vertex_count = graph_.GetVertexCount();
+        RelaxRoutesInternalDataBlocked();
+    }
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
 
-        for (VertexId vid = 0; vid < vertex_count; ++vid) {
-            RelaxRoutesInternalDataThroughVertex(vertex_count, vid);
+    // Total weight only: a single table read unless the table stores narrowed weights
+    std::optional<Weight> GetRouteWeight(VertexId from, VertexId to) const {
+        if constexpr (std::is_same_v<Weight, TableWeight>) {
+            if (from >= routes_internal_data_.vertex_count || to >= routes_internal_data_.vertex_count) {
+                throw std::out_of_range("Vertex id is out of range");
+            }
+            const TableWeight weight = routes_internal_data_.weights[GetIndex(from, to)];
+            if (weight == INFINITE_WEIGHT) {
+                return std::nullopt;
+            }
+            return weight;
+        }
+        else {
+            if (const auto route = BuildRoute(from, to)) {
+                return route->weight;
+            }
+            return std::nullopt;
         }
     }
 
-    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+    const RoutesInternalData& GetRoutesInternalData() const {
+        return routes_internal_data_;
+    }
+
+    static size_t GetMemoryUsage(size_t vertex_count) {
+        return vertex_count * vertex_count * (sizeof(TableWeight) + sizeof(TableEdgeId));
+    }
+
+    size_t GetMemoryUsage() const {
+        return routes_internal_data_.weights.capacity() * sizeof(TableWeight)
+            + routes_internal_data_.prev_edges.capacity() * sizeof(TableEdgeId);
+    }
 
 private:
-    struct RouteInternalData {
-        Weight weight;
-        std::optional<EdgeId> prev_edge;
-    };
-    using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
+    // Tiles are sized so that the three tiles touched by one update stay in L1/L2 cache
+    static constexpr size_t BLOCK_SIZE = 64;
+
+    size_t GetIndex(VertexId from, VertexId to) const {
+        return from * routes_internal_data_.vertex_count + to;
+    }
 
     void InitializeRoutesInternalData(const Graph& graph) {
+        if (graph.GetEdgeCount() >= NO_EDGE) {
+            throw std::length_error("Too many edges for the routes table");
+        }
+
         const size_t vertex_count = graph.GetVertexCount();
+        routes_internal_data_.vertex_count = vertex_count;
+        routes_internal_data_.weights.assign(vertex_count * vertex_count, INFINITE_WEIGHT);
+        routes_internal_data_.prev_edges.assign(vertex_count * vertex_count, NO_EDGE);
+
         for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
-            routes_internal_data_[vertex][vertex] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
+            routes_internal_data_.weights[GetIndex(vertex, vertex)] = ZERO_WEIGHT;
             for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
                 const auto& edge = graph.GetEdge(edge_id);
                 if (edge.weight < ZERO_WEIGHT) {
                     throw std::domain_error("Edges' weights should be non-negative");
                 }
-                auto& route_internal_data = routes_internal_data_[vertex][edge.to];
-                if (!route_internal_data || route_internal_data->weight > edge.weight) {
-                    route_internal_data = RouteInternalData{edge.weight, edge_id};
+                const size_t index = GetIndex(vertex, edge.to);
+                const TableWeight weight = static_cast<TableWeight>(edge.weight);
+                if (routes_internal_data_.weights[index] > weight) {
+                    routes_internal_data_.weights[index] = weight;
+                    routes_internal_data_.prev_edges[index] = static_cast<TableEdgeId>(edge_id);
                 }
             }
         }
     }
 
-    void RelaxRoute(VertexId vertex_from, VertexId vertex_to, const RouteInternalData& route_from,
-                    const RouteInternalData& route_to) {
-        auto& route_relaxing = routes_internal_data_[vertex_from][vertex_to];
-        const Weight candidate_weight = route_from.weight + route_to.weight;
-        if (!route_relaxing || candidate_weight < route_relaxing->weight) {
-            route_relaxing = {candidate_weight,
-                              route_to.prev_edge ? route_to.prev_edge : route_from.prev_edge};
+    // Relaxes every route starting in tile row block_from and ending in tile column block_to
+    // through the vertices of tile block_through
+    void RelaxBlock(size_t block_from, size_t block_to, size_t block_through) {
+        const size_t vertex_count = routes_internal_data_.vertex_count;
+        const size_t through_end = std::min(vertex_count, (block_through + 1) * BLOCK_SIZE);
+        const size_t from_end = std::min(vertex_count, (block_from + 1) * BLOCK_SIZE);
+        const size_t to_begin = block_to * BLOCK_SIZE;
+        const size_t to_end = std::min(vertex_count, to_begin + BLOCK_SIZE);
+
+        TableWeight* weights = routes_internal_data_.weights.data();
+        TableEdgeId* prev_edges = routes_internal_data_.prev_edges.data();
+
+        for (VertexId vertex_through = block_through * BLOCK_SIZE; vertex_through < through_end; ++vertex_through) {
+            const TableWeight* through_weights = weights + vertex_through * vertex_count;
+            const TableEdgeId* through_prev_edges = prev_edges + vertex_through * vertex_count;
+
+            for (VertexId vertex_from = block_from * BLOCK_SIZE; vertex_from < from_end; ++vertex_from) {
+                const size_t from_row = vertex_from * vertex_count;
+                const TableWeight weight_from = weights[from_row + vertex_through];
+                if (weight_from == INFINITE_WEIGHT) {
+                    continue;
+                }
+                const TableEdgeId prev_edge_from = prev_edges[from_row + vertex_through];
+
+                detail::RelaxRow(through_weights + to_begin, through_prev_edges + to_begin,
+                                 weight_from, prev_edge_from,
+                                 weights + from_row + to_begin, prev_edges + from_row + to_begin, to_end - to_begin,
+                                 INFINITE_WEIGHT, NO_EDGE, use_simd_);
+            }
         }
     }
 
-    void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
-        for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
-            if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
-                for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
-                    if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
-                        RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
+    // Blocked Floyd-Warshall: for every diagonal tile the tile itself is relaxed first, then the
+    // tiles sharing its row or column, then all others. Tiles inside the last two phases are
+    // independent of each other and are spread across worker threads, which are started once and
+    // meet at a barrier between phases.
+    void RelaxRoutesInternalDataBlocked() {
+        const size_t block_count = (routes_internal_data_.vertex_count + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        const size_t worker_count = std::max<size_t>(1, std::min(thread_count_, block_count));
+        detail::Barrier barrier(worker_count);
+
+        auto relax = [this, block_count, worker_count, &barrier](size_t worker) {
+            for (size_t block_through = 0; block_through < block_count; ++block_through) {
+                if (worker == 0) {
+                    RelaxBlock(block_through, block_through, block_through);
+                }
+                barrier.Wait();
+
+                for (size_t block = worker; block < block_count; block += worker_count) {
+                    if (block != block_through) {
+                        RelaxBlock(block_through, block, block_through);
+                        RelaxBlock(block, block_through, block_through);
                     }
                 }
+                barrier.Wait();
+
+                for (size_t block_from = worker; block_from < block_count; block_from += worker_count) {
+                    if (block_from == block_through) {
+                        continue;
+                    }
+                    for (size_t block_to = 0; block_to < block_count; ++block_to) {
+                        if (block_to != block_through) {
+                            RelaxBlock(block_from, block_to, block_through);
+                        }
+                    }
+                }
+                barrier.Wait();
             }
+        };
+
+        std::vector<std::thread> workers;
+        workers.reserve(worker_count - 1);
+        for (size_t worker = 1; worker < worker_count; ++worker) {
+            workers.emplace_back(relax, worker);
+        }
+        relax(0);
+        for (auto& worker : workers) {
+            worker.join();
         }
     }
 
-    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr TableWeight ZERO_WEIGHT{};
     const Graph& graph_;
+    size_t thread_count_ = 1;
+    bool use_simd_ = true;
     RoutesInternalData routes_internal_data_;
 };
 
-template <typename Weight>
-Router<Weight>::Router(const Graph& graph)
+template <typename Weight, typename TableWeight>
+Router<Weight, TableWeight>::Router(const Graph& graph, size_t thread_count)
     : graph_(graph)
-    , routes_internal_data_(graph.GetVertexCount(),
-                            std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
+    , thread_count_(thread_count > 0 ? thread_count : std::max(1u, std::thread::hardware_concurrency()))
 {
-    InitializeRoutesInternalData(graph);
+    Build();
+}
 
+template <typename Weight, typename TableWeight>
+Router<Weight, TableWeight>::Router(const Graph& graph, RoutesInternalData routes_internal_data)
+    : graph_(graph)
+    , routes_internal_data_(std::move(routes_internal_data))
+{
     const size_t vertex_count = graph.GetVertexCount();
-    for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
-        RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+    if (routes_internal_data_.vertex_count != vertex_count
+        || routes_internal_data_.weights.size() != vertex_count * vertex_count
+        || routes_internal_data_.prev_edges.size() != vertex_count * vertex_count) {
+        throw std::invalid_argument("Routes table does not match the graph");
     }
 }
 
-template <typename Weight>
-std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
-                                                                             VertexId to) const {
-    const auto& route_internal_data = routes_internal_data_.at(from).at(to);
-    if (!route_internal_data) {
+template <typename Weight, typename TableWeight>
+std::optional<typename Router<Weight, TableWeight>::RouteInfo> Router<Weight, TableWeight>::BuildRoute(VertexId from,
+                                                                                                       VertexId to) const {
+    const size_t vertex_count = routes_internal_data_.vertex_count;
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    if (routes_internal_data_.weights[GetIndex(from, to)] == INFINITE_WEIGHT) {
         return std::nullopt;
     }
-    const Weight weight = route_internal_data->weight;
     std::vector<EdgeId> edges;
-    for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
-         edge_id;
-         edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
+    for (TableEdgeId edge_id = routes_internal_data_.prev_edges[GetIndex(from, to)];
+         edge_id != NO_EDGE;
+         edge_id = routes_internal_data_.prev_edges[GetIndex(from, graph_.GetEdge(edge_id).from)])
     {
-        edges.push_back(*edge_id);
+        edges.push_back(edge_id);
     }
     std::reverse(edges.begin(), edges.end());
 
+    Weight weight{};
+    if constexpr (std::is_same_v<Weight, TableWeight>) {
+        weight = routes_internal_data_.weights[GetIndex(from, to)];
+    }
+    else {
+        for (const EdgeId edge_id : edges) {
+            weight += graph_.GetEdge(edge_id).weight;
+        }
+    }
+
     return RouteInfo{weight, std::move(edges)};
 }
 
-}  // namespace graph
\ No newline at end of file
+}  // namespace graph
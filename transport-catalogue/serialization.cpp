@@ -1,5 +1,8 @@
 #include "serialization.h"
 
+#include <cmath>
+#include <limits>
+
 namespace serialization {
 
 template <typename It>
@@ -27,7 +30,7 @@ void SerializeStops(transport_catalogue_protobuf::TransportCatalogue& catalogue_
     }
 }
 
-void SerializeBuses(transport_catalogue_protobuf::TransportCatalogue& catalogue_serialized, const std::deque<Stop>& stops, const std::deque<Bus>& buses) {
+void SerializeBuses(transport_catalogue_protobuf::TransportCatalogue& catalogue_serialized, const transport_catalogue::TransportCatalogue& catalogue, const std::deque<Stop>& stops, const std::deque<Bus>& buses) {
     for (const auto& bus : buses) {
  
         transport_catalogue_protobuf::Bus bus_serialized;
@@ -41,6 +44,12 @@ void SerializeBuses(transport_catalogue_protobuf::TransportCatalogue& catalogue_
  
         bus_serialized.set_is_roundtrip(bus.is_roundtrip);
         bus_serialized.set_route_length(bus.route_length);
+
+        const auto& stats = catalogue.GetBusStats(&bus);
+        auto& stats_serialized = *bus_serialized.mutable_stats();
+        stats_serialized.set_unique_stop_count(stats.unique_stop_count);
+        stats_serialized.set_geo_length(stats.geo_length);
+        stats_serialized.set_curvature(stats.curvature);
  
         *catalogue_serialized.add_buses() = std::move(bus_serialized);
     }
@@ -67,7 +76,7 @@ transport_catalogue_protobuf::TransportCatalogue SerializeTransportCatalogue(con
     SerializeStops(catalogue_serialized, stops);
 
     const auto& buses = catalogue.GetBuses();
-    SerializeBuses(catalogue_serialized, stops, buses);
+    SerializeBuses(catalogue_serialized, catalogue, stops, buses);
 
     const auto& distances = catalogue.GetDistances();
     SerializeDistances(catalogue_serialized, stops, distances);
@@ -115,14 +124,25 @@ void DeserializeBuses(transport_catalogue::TransportCatalogue& catalogue, const
         bus_tmp.name = bus_proto.name();
  
         for (auto stop_id : bus_proto.stops()) {
-            auto name = stops_tmp[stop_id].name;            
+            const auto& name = stops_tmp[stop_id].name;
             bus_tmp.stops.push_back(catalogue.GetStop(name));
         }
  
         bus_tmp.is_roundtrip = bus_proto.is_roundtrip();
         bus_tmp.route_length = bus_proto.route_length();
-        
-        catalogue.AddBus(std::move(bus_tmp));
+
+        // Bases written before the stats were stored get them recomputed
+        if (bus_proto.has_stats()) {
+            domain::BusStats stats;
+            stats.unique_stop_count = bus_proto.stats().unique_stop_count();
+            stats.route_length = bus_proto.route_length();
+            stats.geo_length = bus_proto.stats().geo_length();
+            stats.curvature = bus_proto.stats().curvature();
+            catalogue.AddBus(std::move(bus_tmp), stats);
+        }
+        else {
+            catalogue.AddBus(std::move(bus_tmp));
+        }
     } 
 }
 
@@ -273,6 +293,17 @@ transport_catalogue_protobuf::RoutingSettings SerializeRoutingSettings(const dom
     
     routing_settings_serialized.set_bus_wait_time(routing_settings.bus_wait_time);
     routing_settings_serialized.set_bus_velocity(routing_settings.bus_velocity);
+    routing_settings_serialized.set_router_type(static_cast<transport_catalogue_protobuf::RoutingSettings::RouterType>(routing_settings.router_type));
+    routing_settings_serialized.set_thread_count(routing_settings.thread_count);
+    routing_settings_serialized.set_routes_table_layout(static_cast<transport_catalogue_protobuf::RoutingSettings::RoutesTableLayout>(routing_settings.routes_table_layout));
+    routing_settings_serialized.set_graph_model(static_cast<transport_catalogue_protobuf::RoutingSettings::GraphModel>(routing_settings.graph_model));
+    routing_settings_serialized.set_integer_weights(routing_settings.integer_weights);
+    routing_settings_serialized.set_route_cache_size(routing_settings.route_cache_size);
+    routing_settings_serialized.set_alternatives_max_searches(routing_settings.alternatives_max_searches);
+    routing_settings_serialized.set_alternatives_max_milliseconds(routing_settings.alternatives_max_milliseconds);
+    for (const auto& [bus_name, headway] : routing_settings.bus_headways) {
+        (*routing_settings_serialized.mutable_bus_headways())[bus_name] = headway;
+    }
  
     return routing_settings_serialized;
 }
@@ -282,11 +313,257 @@ domain::RoutingSettings DeserializeRoutingSettings(const transport_catalogue_pro
     
     routing_settings.bus_wait_time = routing_settings_serialized.bus_wait_time();
     routing_settings.bus_velocity = routing_settings_serialized.bus_velocity();
+    routing_settings.router_type = static_cast<domain::RouterType>(routing_settings_serialized.router_type());
+    routing_settings.thread_count = routing_settings_serialized.thread_count();
+    routing_settings.routes_table_layout = static_cast<domain::RoutesTableLayout>(routing_settings_serialized.routes_table_layout());
+    routing_settings.graph_model = static_cast<domain::GraphModel>(routing_settings_serialized.graph_model());
+    routing_settings.integer_weights = routing_settings_serialized.integer_weights();
+    routing_settings.route_cache_size = routing_settings_serialized.route_cache_size();
+    routing_settings.alternatives_max_searches = routing_settings_serialized.alternatives_max_searches();
+    routing_settings.alternatives_max_milliseconds = routing_settings_serialized.alternatives_max_milliseconds();
+    for (const auto& [bus_name, headway] : routing_settings_serialized.bus_headways()) {
+        routing_settings.bus_headways.emplace(bus_name, headway);
+    }
     
     return routing_settings;
 }
 
-void SerializeTransportCatalogueUnion(transport_catalogue::TransportCatalogue& catalogue, map_renderer::RenderSettings& render_settings, const domain::RoutingSettings& routing_settings, std::ostream& os) {
+transport_catalogue_protobuf::ContractionHierarchy SerializeContractionHierarchy(const graph::ContractionHierarchyData<double>& contraction_hierarchy) {
+    transport_catalogue_protobuf::ContractionHierarchy contraction_hierarchy_serialized;
+
+    contraction_hierarchy_serialized.set_vertex_count(contraction_hierarchy.vertex_count);
+    contraction_hierarchy_serialized.set_edge_count(contraction_hierarchy.edge_count);
+
+    for (const auto rank : contraction_hierarchy.ranks) {
+        contraction_hierarchy_serialized.add_ranks(rank);
+    }
+
+    for (const auto& shortcut : contraction_hierarchy.shortcuts) {
+        transport_catalogue_protobuf::Shortcut shortcut_serialized;
+
+        shortcut_serialized.set_from(shortcut.from);
+        shortcut_serialized.set_to(shortcut.to);
+        shortcut_serialized.set_weight(shortcut.weight);
+        shortcut_serialized.set_first_edge(shortcut.first_edge);
+        shortcut_serialized.set_second_edge(shortcut.second_edge);
+
+        *contraction_hierarchy_serialized.add_shortcuts() = std::move(shortcut_serialized);
+    }
+
+    return contraction_hierarchy_serialized;
+}
+
+graph::ContractionHierarchyData<double> DeserializeContractionHierarchy(const transport_catalogue_protobuf::ContractionHierarchy& contraction_hierarchy_serialized) {
+    graph::ContractionHierarchyData<double> contraction_hierarchy;
+
+    contraction_hierarchy.vertex_count = contraction_hierarchy_serialized.vertex_count();
+    contraction_hierarchy.edge_count = contraction_hierarchy_serialized.edge_count();
+    contraction_hierarchy.ranks.assign(contraction_hierarchy_serialized.ranks().begin(), contraction_hierarchy_serialized.ranks().end());
+
+    contraction_hierarchy.shortcuts.reserve(contraction_hierarchy_serialized.shortcuts_size());
+    for (const auto& shortcut : contraction_hierarchy_serialized.shortcuts()) {
+        contraction_hierarchy.shortcuts.push_back({ shortcut.from(), shortcut.to(), shortcut.weight(), shortcut.first_edge(), shortcut.second_edge() });
+    }
+
+    return contraction_hierarchy;
+}
+
+transport_catalogue_protobuf::Graph SerializeGraph(const graph::DirectedWeightedGraph<double>& graph) {
+    transport_catalogue_protobuf::Graph graph_serialized;
+
+    graph_serialized.set_vertex_count(graph.GetVertexCount());
+
+    for (graph::EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        const auto& edge = graph.GetEdge(edge_id);
+        transport_catalogue_protobuf::Edge* edge_serialized = graph_serialized.add_edges();
+
+        edge_serialized->set_from(edge.from);
+        edge_serialized->set_to(edge.to);
+        edge_serialized->set_weight(edge.weight);
+    }
+
+    return graph_serialized;
+}
+
+graph::DirectedWeightedGraph<double> DeserializeGraph(const transport_catalogue_protobuf::Graph& graph_serialized) {
+    graph::DirectedWeightedGraph<double> graph(graph_serialized.vertex_count());
+
+    for (const auto& edge : graph_serialized.edges()) {
+        graph.AddEdge({ edge.from(), edge.to(), edge.weight() });
+    }
+
+    return graph;
+}
+
+template <typename Weight, typename TableWeight>
+transport_catalogue_protobuf::RoutesInternalData SerializeRoutesInternalData(const typename graph::Router<Weight, TableWeight>::RoutesInternalData& routes_internal_data) {
+    using Router = graph::Router<Weight, TableWeight>;
+    transport_catalogue_protobuf::RoutesInternalData routes_internal_data_serialized;
+
+    routes_internal_data_serialized.set_vertex_count(routes_internal_data.vertex_count);
+    routes_internal_data_serialized.mutable_weights()->Reserve(routes_internal_data.weights.size());
+    routes_internal_data_serialized.mutable_prev_edges()->Reserve(routes_internal_data.prev_edges.size());
+
+    for (const TableWeight weight : routes_internal_data.weights) {
+        routes_internal_data_serialized.add_weights(weight == Router::INFINITE_WEIGHT ? std::numeric_limits<double>::infinity() : weight);
+    }
+
+    for (const uint32_t prev_edge : routes_internal_data.prev_edges) {
+        routes_internal_data_serialized.add_prev_edges(prev_edge == Router::NO_EDGE ? 0 : prev_edge + 1);
+    }
+
+    return routes_internal_data_serialized;
+}
+
+template <typename Weight, typename TableWeight>
+typename graph::Router<Weight, TableWeight>::RoutesInternalData DeserializeRoutesInternalData(const transport_catalogue_protobuf::RoutesInternalData& routes_internal_data_serialized) {
+    using Router = graph::Router<Weight, TableWeight>;
+    typename Router::RoutesInternalData routes_internal_data;
+    const size_t vertex_count = routes_internal_data_serialized.vertex_count();
+
+    if (static_cast<size_t>(routes_internal_data_serialized.weights_size()) != vertex_count * vertex_count
+        || static_cast<size_t>(routes_internal_data_serialized.prev_edges_size()) != vertex_count * vertex_count) {
+        throw std::runtime_error("Failed to parse serialized routes table");
+    }
+
+    routes_internal_data.vertex_count = vertex_count;
+    routes_internal_data.weights.reserve(vertex_count * vertex_count);
+    routes_internal_data.prev_edges.reserve(vertex_count * vertex_count);
+
+    for (const double weight : routes_internal_data_serialized.weights()) {
+        routes_internal_data.weights.push_back(std::isinf(weight) ? Router::INFINITE_WEIGHT : static_cast<TableWeight>(weight));
+    }
+
+    for (const uint32_t prev_edge : routes_internal_data_serialized.prev_edges()) {
+        routes_internal_data.prev_edges.push_back(prev_edge == 0 ? Router::NO_EDGE : prev_edge - 1);
+    }
+
+    return routes_internal_data;
+}
+
+transport_catalogue_protobuf::TransportRouter SerializeTransportRouter(const transport_catalogue::TransportCatalogue& catalogue, const transport_catalogue::detail::router::TransportRouter& router) {
+    transport_catalogue_protobuf::TransportRouter router_serialized;
+
+    // Stops and buses are referenced by their position in the serialized catalogue
+    const auto& stops = catalogue.GetStops();
+    std::unordered_map<std::string_view, uint32_t> stop_ids;
+    for (const auto& stop : stops) {
+        stop_ids.emplace(stop.name, stop_ids.size());
+    }
+
+    const auto& buses = catalogue.GetBuses();
+    std::unordered_map<std::string_view, uint32_t> bus_ids;
+    for (const auto& bus : buses) {
+        bus_ids.emplace(bus.name, bus_ids.size());
+    }
+
+    *router_serialized.mutable_graph() = SerializeGraph(router.GetGraph());
+
+    const auto& edge_id_to_edge = router.GetEdgeIdToEdge();
+    for (graph::EdgeId edge_id = 0; edge_id < router.GetGraph().GetEdgeCount(); ++edge_id) {
+        transport_catalogue_protobuf::EdgeInfo* edge_serialized = router_serialized.add_edges();
+        const auto& edge = edge_id_to_edge[edge_id];
+
+        if (std::holds_alternative<domain::StopEdge>(edge)) {
+            const auto& stop_edge = std::get<domain::StopEdge>(edge);
+            edge_serialized->mutable_stop_edge()->set_stop_id(stop_ids.at(stop_edge.name));
+            edge_serialized->mutable_stop_edge()->set_time(stop_edge.time);
+        }
+        else {
+            const auto& bus_edge = std::get<domain::BusEdge>(edge);
+            edge_serialized->mutable_bus_edge()->set_bus_id(bus_ids.at(bus_edge.name));
+            edge_serialized->mutable_bus_edge()->set_span_count(bus_edge.span_count);
+            edge_serialized->mutable_bus_edge()->set_time(bus_edge.time);
+            edge_serialized->mutable_bus_edge()->set_distance(bus_edge.distance);
+        }
+    }
+
+    const auto& stop_to_route = router.GetStopToRoute();
+    for (uint32_t stop_id = 0; stop_id < stop_to_route.size(); ++stop_id) {
+        const auto& wait_range = stop_to_route[stop_id];
+        transport_catalogue_protobuf::WaitRange* wait_range_serialized = router_serialized.add_wait_ranges();
+
+        wait_range_serialized->set_stop_id(stop_id);
+        wait_range_serialized->set_bus_wait_start(wait_range.bus_wait_start);
+        wait_range_serialized->set_bus_wait_end(wait_range.bus_wait_end);
+        wait_range_serialized->set_strong_component(router.GetStrongComponents().at(stop_id));
+        wait_range_serialized->set_weak_component(router.GetWeakComponents().at(stop_id));
+    }
+
+    if (const auto* all_pairs_router = router.GetRouter()) {
+        *router_serialized.mutable_routes_internal_data() = SerializeRoutesInternalData<double, double>(all_pairs_router->GetRoutesInternalData());
+    }
+
+    if (const auto* compact_router = router.GetCompactRouter()) {
+        *router_serialized.mutable_compact_routes_internal_data() = SerializeRoutesInternalData<double, float>(compact_router->GetRoutesInternalData());
+    }
+
+    if (const auto* integer_router = router.GetIntegerRouter()) {
+        *router_serialized.mutable_integer_routes_internal_data() = SerializeRoutesInternalData<uint32_t, uint32_t>(integer_router->GetRoutesInternalData());
+    }
+
+    if (const auto* contraction_hierarchy = router.GetContractionHierarchy()) {
+        *router_serialized.mutable_contraction_hierarchy() = SerializeContractionHierarchy(contraction_hierarchy->GetData());
+    }
+
+    return router_serialized;
+}
+
+transport_catalogue::detail::router::TransportRouterData DeserializeTransportRouter(transport_catalogue::TransportCatalogue& catalogue, const transport_catalogue_protobuf::TransportRouter& router_serialized) {
+    transport_catalogue::detail::router::TransportRouterData router_data;
+
+    std::vector<domain::Stop*> stops;
+    for (const auto& stop : catalogue.GetStops()) {
+        stops.push_back(catalogue.GetStop(stop.name));
+    }
+
+    std::vector<domain::Bus*> buses;
+    for (const auto& bus : catalogue.GetBuses()) {
+        buses.push_back(catalogue.GetBus(bus.name));
+    }
+
+    router_data.graph = DeserializeGraph(router_serialized.graph());
+
+    router_data.edge_id_to_edge.reserve(router_serialized.edges_size());
+    for (const auto& edge : router_serialized.edges()) {
+        if (edge.has_stop_edge()) {
+            router_data.edge_id_to_edge.emplace_back(domain::StopEdge{ stops.at(edge.stop_edge().stop_id())->name, edge.stop_edge().time() });
+        }
+        else {
+            router_data.edge_id_to_edge.emplace_back(domain::BusEdge{ buses.at(edge.bus_edge().bus_id())->name, edge.bus_edge().span_count(), edge.bus_edge().time(), edge.bus_edge().distance() });
+        }
+    }
+
+    // Stop ids in the base are positions in the catalogue, the same as Stop::id after loading
+    router_data.stop_to_route.resize(stops.size());
+    router_data.strong_components.resize(stops.size());
+    router_data.weak_components.resize(stops.size());
+    for (const auto& wait_range : router_serialized.wait_ranges()) {
+        router_data.stop_to_route.at(wait_range.stop_id()) = domain::WaitRange{ wait_range.bus_wait_start(), wait_range.bus_wait_end() };
+        router_data.strong_components.at(wait_range.stop_id()) = wait_range.strong_component();
+        router_data.weak_components.at(wait_range.stop_id()) = wait_range.weak_component();
+    }
+
+    if (router_serialized.has_routes_internal_data()) {
+        router_data.routes_internal_data = DeserializeRoutesInternalData<double, double>(router_serialized.routes_internal_data());
+    }
+
+    if (router_serialized.has_compact_routes_internal_data()) {
+        router_data.compact_routes_internal_data = DeserializeRoutesInternalData<double, float>(router_serialized.compact_routes_internal_data());
+    }
+
+    if (router_serialized.has_integer_routes_internal_data()) {
+        router_data.integer_routes_internal_data = DeserializeRoutesInternalData<uint32_t, uint32_t>(router_serialized.integer_routes_internal_data());
+    }
+
+    if (router_serialized.has_contraction_hierarchy()) {
+        router_data.contraction_hierarchy = DeserializeContractionHierarchy(router_serialized.contraction_hierarchy());
+    }
+
+    return router_data;
+}
+
+void SerializeTransportCatalogueUnion(transport_catalogue::TransportCatalogue& catalogue, map_renderer::RenderSettings& render_settings, const domain::RoutingSettings& routing_settings, const transport_catalogue::detail::router::TransportRouter* router, std::ostream& os) {
     transport_catalogue_protobuf::TransportCatalogueUnion transport_catalogue_union_serialized;
  
     transport_catalogue_protobuf::TransportCatalogue transport_catalogue_serialized = SerializeTransportCatalogue(catalogue);
@@ -296,18 +573,32 @@ void SerializeTransportCatalogueUnion(transport_catalogue::TransportCatalogue& c
     *transport_catalogue_union_serialized.mutable_transport_catalogue() = std::move(transport_catalogue_serialized);
     *transport_catalogue_union_serialized.mutable_render_settings() = std::move(render_settings_serialized);
     *transport_catalogue_union_serialized.mutable_routing_settings() = std::move(routing_settings_serialized);
+
+    if (router) {
+        *transport_catalogue_union_serialized.mutable_transport_router() = SerializeTransportRouter(catalogue, *router);
+    }
  
     transport_catalogue_union_serialized.SerializePartialToOstream(&os);
 }    
 
-TransportCatalogueUnion DeserializeTransportCatalogueUnion(std::istream& is) {
+TransportCatalogueUnion DeserializeTransportCatalogueUnion(std::istream& is, bool with_router) {
     transport_catalogue_protobuf::TransportCatalogueUnion transport_catalogue_union_serialized;
 
     if (!transport_catalogue_union_serialized.ParseFromIstream(&is)) {
         throw std::runtime_error("Failed to parse serialized file");
     }
  
-    return { DeserializeTransportCatalogue(transport_catalogue_union_serialized.transport_catalogue()), DeserializeRenderSettings(transport_catalogue_union_serialized.render_settings()), DeserializeRoutingSettings(transport_catalogue_union_serialized.routing_settings()) };
+    TransportCatalogueUnion transport_catalogue_union{ DeserializeTransportCatalogue(transport_catalogue_union_serialized.transport_catalogue()), DeserializeRenderSettings(transport_catalogue_union_serialized.render_settings()), DeserializeRoutingSettings(transport_catalogue_union_serialized.routing_settings()), std::nullopt };
+
+    // Unpacking the stored router is skipped when the caller will not route anything
+    if (with_router && transport_catalogue_union_serialized.has_transport_router()
+        && transport_catalogue_union_serialized.transport_router().has_graph()) {
+        transport_catalogue_union.router_data_ = DeserializeTransportRouter(transport_catalogue_union.transport_catalogue_, transport_catalogue_union_serialized.transport_router());
+        transport_catalogue_union.router_data_->bus_wait_time = transport_catalogue_union.routing_settings_.bus_wait_time;
+        transport_catalogue_union.router_data_->bus_velocity = transport_catalogue_union.routing_settings_.bus_velocity;
+    }
+
+    return transport_catalogue_union;
 }
 
 } // namespace serialization
\ No newline at end of file
@@ -8,6 +8,10 @@
 
 #include "svg.pb.h"
 
+#include "graph.pb.h"
+#include "transport_router.h"
+#include "transport_router.pb.h"
+
 #include <iostream>
 
 namespace serialization {
@@ -20,13 +24,14 @@ struct TransportCatalogueUnion {
     transport_catalogue::TransportCatalogue transport_catalogue_;
     map_renderer::RenderSettings render_settings_;
     domain::RoutingSettings routing_settings_;
+    std::optional<transport_catalogue::detail::router::TransportRouterData> router_data_;
 };
 
 template <typename It>
 uint32_t CalculateDistance(It range_begin, It range_end, std::string_view name);
 
 void SerializeStops(transport_catalogue_protobuf::TransportCatalogue& catalogue_serialized, const std::deque<Stop>& stops);
-void SerializeBuses(transport_catalogue_protobuf::TransportCatalogue& catalogue_serialized, const std::deque<Stop>& stops, const std::deque<Bus>& buses);
+void SerializeBuses(transport_catalogue_protobuf::TransportCatalogue& catalogue_serialized, const transport_catalogue::TransportCatalogue& catalogue, const std::deque<Stop>& stops, const std::deque<Bus>& buses);
 void SerializeDistances(transport_catalogue_protobuf::TransportCatalogue& catalogue_serialized, const std::deque<Stop>& stops, const transport_catalogue::DistanceDict& distances);
 transport_catalogue_protobuf::TransportCatalogue SerializeTransportCatalogue(const transport_catalogue::TransportCatalogue& catalogue);
 
@@ -44,7 +49,21 @@ map_renderer::RenderSettings DeserializeRenderSettings(const transport_catalogue
 transport_catalogue_protobuf::RoutingSettings SerializeRoutingSettings(const domain::RoutingSettings& routing_settings);
 domain::RoutingSettings DeserializeRoutingSettings(const transport_catalogue_protobuf::RoutingSettings& routing_settings_serialized);
 
-void SerializeTransportCatalogueUnion(transport_catalogue::TransportCatalogue& catalogue, map_renderer::RenderSettings& render_settings, const domain::RoutingSettings& routing_settings, std::ostream& os);    
-TransportCatalogueUnion DeserializeTransportCatalogueUnion(std::istream& is);
+transport_catalogue_protobuf::ContractionHierarchy SerializeContractionHierarchy(const graph::ContractionHierarchyData<double>& contraction_hierarchy);
+graph::ContractionHierarchyData<double> DeserializeContractionHierarchy(const transport_catalogue_protobuf::ContractionHierarchy& contraction_hierarchy_serialized);
+
+transport_catalogue_protobuf::Graph SerializeGraph(const graph::DirectedWeightedGraph<double>& graph);
+graph::DirectedWeightedGraph<double> DeserializeGraph(const transport_catalogue_protobuf::Graph& graph_serialized);
+
+template <typename Weight, typename TableWeight>
+transport_catalogue_protobuf::RoutesInternalData SerializeRoutesInternalData(const typename graph::Router<Weight, TableWeight>::RoutesInternalData& routes_internal_data);
+template <typename Weight, typename TableWeight>
+typename graph::Router<Weight, TableWeight>::RoutesInternalData DeserializeRoutesInternalData(const transport_catalogue_protobuf::RoutesInternalData& routes_internal_data_serialized);
+
+transport_catalogue_protobuf::TransportRouter SerializeTransportRouter(const transport_catalogue::TransportCatalogue& catalogue, const transport_catalogue::detail::router::TransportRouter& router);
+transport_catalogue::detail::router::TransportRouterData DeserializeTransportRouter(transport_catalogue::TransportCatalogue& catalogue, const transport_catalogue_protobuf::TransportRouter& router_serialized);
+
+void SerializeTransportCatalogueUnion(transport_catalogue::TransportCatalogue& catalogue, map_renderer::RenderSettings& render_settings, const domain::RoutingSettings& routing_settings, const transport_catalogue::detail::router::TransportRouter* router, std::ostream& os);    
+TransportCatalogueUnion DeserializeTransportCatalogueUnion(std::istream& is, bool with_router = true);
 
 } // namespace serialization
\ No newline at end of file
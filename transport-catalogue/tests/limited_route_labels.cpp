@@ -0,0 +1,135 @@
+// Checks that BuildLimitedRoute finds the fastest route with at most max_count counted edges
+// and that its label count stays within the (max_count + 1) labels settled per vertex:
+// every edge is examined once per settled label, so is_counted runs at most
+// (max_count + 1) * edge_count times.
+
+#include "../dijkstra_router.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <random>
+#include <vector>
+
+namespace {
+
+using Graph = graph::DirectedWeightedGraph<double>;
+
+struct Case {
+	Graph graph;
+	std::vector<bool> counted;
+};
+
+// More counted edges are always faster, so every vertex settles all max_count + 1 labels
+Case MakeChain(size_t vertex_count) {
+	Case result{ Graph(vertex_count), {} };
+	for (graph::VertexId vertex = 0; vertex + 1 < vertex_count; ++vertex) {
+		result.graph.AddEdge({ vertex, vertex + 1, 1.0 });
+		result.counted.push_back(true);
+		result.graph.AddEdge({ vertex, vertex + 1, 3.0 });
+		result.counted.push_back(false);
+	}
+	return result;
+}
+
+Case MakeRandom(size_t vertex_count, size_t edge_count, unsigned seed) {
+	std::mt19937 generator(seed);
+	std::uniform_int_distribution<graph::VertexId> vertex(0, vertex_count - 1);
+	std::uniform_int_distribution<int> weight(1, 20);
+	std::bernoulli_distribution is_counted(0.4);
+
+	Case result{ Graph(vertex_count), {} };
+	for (size_t i = 0; i < edge_count; ++i) {
+		result.graph.AddEdge({ vertex(generator), vertex(generator), static_cast<double>(weight(generator)) });
+		result.counted.push_back(is_counted(generator));
+	}
+	return result;
+}
+
+// Bellman-Ford over (vertex, count) states
+std::optional<double> ReferenceWeight(const Case& test_case, graph::VertexId from, graph::VertexId to, size_t max_count) {
+	constexpr double INF = std::numeric_limits<double>::infinity();
+	const Graph& graph = test_case.graph;
+	std::vector<std::vector<double>> weights(max_count + 1, std::vector<double>(graph.GetVertexCount(), INF));
+	weights[0][from] = 0;
+	for (bool changed = true; changed;) {
+		changed = false;
+		for (size_t count = 0; count <= max_count; ++count) {
+			for (graph::EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+				const auto& edge = graph.GetEdge(edge_id);
+				const size_t next_count = count + (test_case.counted[edge_id] ? 1 : 0);
+				if (next_count <= max_count && weights[count][edge.from] + edge.weight < weights[next_count][edge.to]) {
+					weights[next_count][edge.to] = weights[count][edge.from] + edge.weight;
+					changed = true;
+				}
+			}
+		}
+	}
+
+	double best = INF;
+	for (const auto& count_weights : weights) {
+		best = std::min(best, count_weights[to]);
+	}
+	return best < INF ? std::optional<double>(best) : std::nullopt;
+}
+
+bool Check(const char* name, const Case& test_case, graph::VertexId from, graph::VertexId to, size_t max_count, bool expect_tight) {
+	const graph::DijkstraRouter<double> router(test_case.graph);
+	size_t examined = 0;
+	const auto is_counted = [&](graph::EdgeId edge_id) {
+		++examined;
+		return static_cast<bool>(test_case.counted[edge_id]);
+	};
+	const auto route = router.BuildLimitedRoute(from, to, is_counted, max_count);
+	const size_t bound = (max_count + 1) * test_case.graph.GetEdgeCount();
+
+	std::cout << name << " " << from << "->" << to << " max_count " << max_count << ": "
+		<< examined << " edges examined, bound " << bound << '\n';
+
+	bool ok = examined <= bound;
+	if (expect_tight && examined * 2 < bound) {
+		ok = false;
+	}
+
+	const auto reference = ReferenceWeight(test_case, from, to, max_count);
+	if (route.has_value() != reference.has_value() || (route && route->weight != *reference)) {
+		ok = false;
+	}
+	if (route) {
+		size_t counted_edges = 0;
+		for (const graph::EdgeId edge_id : route->edges) {
+			counted_edges += test_case.counted[edge_id] ? 1 : 0;
+		}
+		ok = ok && counted_edges <= max_count;
+	}
+
+	if (!ok) {
+		std::cerr << name << " " << from << "->" << to << " max_count " << max_count << " failed\n";
+	}
+	return ok;
+}
+
+}  // namespace
+
+int main() {
+	bool ok = true;
+
+	// The target is the last vertex, so the search settles every label before reaching it
+	const Case chain = MakeChain(200);
+	for (size_t max_count : { 0, 1, 3, 10 }) {
+		ok = Check("chain", chain, 0, 199, max_count, true) && ok;
+	}
+
+	for (unsigned seed = 1; seed <= 3; ++seed) {
+		const Case random = MakeRandom(150, 900, seed);
+		for (size_t max_count : { 0, 1, 2, 5 }) {
+			for (graph::VertexId from : { 0, 7, 42 }) {
+				ok = Check("random", random, from, (from * 31 + seed) % 150, max_count, false) && ok;
+			}
+		}
+	}
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,133 @@
+// Counts heap allocations around a Map request on a generated catalogue. The catalogue's read
+// accessors must not allocate at all, and the coordinate and bus name lists are reserved at once.
+// Prints the allocations of a whole Map request next to those that copying the catalogue
+// containers, as the accessors once did, would add to it. The catalogue is the same on every
+// run, so are the numbers.
+
+#include "../json_reader.h"
+#include "../transport_catalogue.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+
+size_t allocation_count = 0;
+
+}  // namespace
+
+void* operator new(size_t size) {
+	++allocation_count;
+	if (void* pointer = std::malloc(size > 0 ? size : 1)) {
+		return pointer;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+	std::free(pointer);
+}
+
+namespace {
+
+using namespace transport_catalogue;
+
+constexpr size_t STOP_COUNT = 2000;
+constexpr size_t BUS_COUNT = 200;
+constexpr size_t STOPS_PER_BUS = 25;
+
+void FillCatalogue(TransportCatalogue& catalogue) {
+	for (size_t i = 0; i < STOP_COUNT; ++i) {
+		Stop stop;
+		stop.name = "Stop " + std::to_string(i);
+		stop.coords = { 55.5 + (i % 50) * 0.01, 37.5 + (i / 50) * 0.01 };
+		catalogue.AddStop(stop);
+	}
+
+	for (size_t i = 0; i < BUS_COUNT; ++i) {
+		Bus bus;
+		bus.name = "Bus " + std::to_string(i);
+		bus.is_roundtrip = false;
+		for (size_t j = 0; j < STOPS_PER_BUS; ++j) {
+			bus.stops.push_back(catalogue.GetStop("Stop " + std::to_string((i * 7 + j * 13) % STOP_COUNT)));
+		}
+		for (size_t j = 0; j + 1 < STOPS_PER_BUS; ++j) {
+			catalogue.AddDistance({ bus.stops[j], bus.stops[j + 1], static_cast<int>(500 + j * 10) });
+		}
+		catalogue.AddBus(bus);
+	}
+}
+
+map_renderer::RenderSettings MakeRenderSettings() {
+	map_renderer::RenderSettings render_settings;
+	render_settings.width = 1200;
+	render_settings.height = 1200;
+	render_settings.padding = 50;
+	render_settings.line_width = 14;
+	render_settings.stop_radius = 5;
+	render_settings.bus_label_font_size = 20;
+	render_settings.bus_label_offset = { 7, 15 };
+	render_settings.stop_label_font_size = 20;
+	render_settings.stop_label_offset = { 7, -3 };
+	render_settings.underlayer_color = svg::Rgb(255, 255, 255);
+	render_settings.underlayer_width = 3;
+	render_settings.color_palette = { std::string("green"), svg::Rgb(255, 160, 0), std::string("red") };
+	return render_settings;
+}
+
+template <typename Function>
+size_t CountAllocations(Function function) {
+	const size_t before = allocation_count;
+	function();
+	return allocation_count - before;
+}
+
+bool Expect(const char* name, size_t allocations, size_t expected) {
+	std::cout << name << ": " << allocations << " allocations\n";
+	if (allocations != expected) {
+		std::cerr << name << ": expected " << expected << " allocations\n";
+		return false;
+	}
+	return true;
+}
+
+}  // namespace
+
+int main() {
+	TransportCatalogue catalogue;
+	FillCatalogue(catalogue);
+	const TransportCatalogue& const_catalogue = catalogue;
+
+	bool ok = Expect("GetStopsAssociative", CountAllocations([&] { return const_catalogue.GetStopsAssociative().size(); }), 0);
+	ok = Expect("GetBusesAssociative", CountAllocations([&] { return const_catalogue.GetBusesAssociative().size(); }), 0) && ok;
+	ok = Expect("GetStops", CountAllocations([&] { return const_catalogue.GetStops().size(); }), 0) && ok;
+	ok = Expect("GetBuses", CountAllocations([&] { return const_catalogue.GetBuses().size(); }), 0) && ok;
+	ok = Expect("GetDistances", CountAllocations([&] { return const_catalogue.GetDistances().size(); }), 0) && ok;
+	ok = Expect("GetStopsCoordinates", CountAllocations([&] { return const_catalogue.GetStopsCoordinates().size(); }), 1) && ok;
+	ok = Expect("GetSortedBusesNames", CountAllocations([&] { return const_catalogue.GetSortedBusesNames().size(); }), 1) && ok;
+
+	const size_t copy_allocations = CountAllocations([&] {
+		const StopDict stops_associative = const_catalogue.GetStopsAssociative();
+		const BusDict buses_associative = const_catalogue.GetBusesAssociative();
+		const std::deque<Stop> stops = const_catalogue.GetStops();
+		const std::deque<Bus> buses = const_catalogue.GetBuses();
+		const DistanceDict distances = const_catalogue.GetDistances();
+	});
+
+	detail::json::Reader reader;
+	auto render_settings = MakeRenderSettings();
+	const size_t map_allocations = CountAllocations([&] { reader.MakeMapNode(1, catalogue, render_settings); });
+
+	std::cout << "Map request on " << STOP_COUNT << " stops and " << BUS_COUNT << " buses: "
+		<< map_allocations << " allocations\n"
+		<< "One copy of the stop, bus and distance containers: " << copy_allocations << " allocations\n";
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,90 @@
+// Checks that the all-pairs table is the same whether the min-plus relaxation runs through the
+// AVX2 kernel or the scalar loop, for every table weight type the transport router uses.
+// With --benchmark [vertex_count] it also prints the build times of both, best measured in an
+// optimized build. Row lengths that are not a multiple of the vector width cover the scalar
+// remainder; small integer weights give ties between routes.
+
+#include "../router.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+template <typename Weight>
+graph::DirectedWeightedGraph<Weight> MakeRandomGraph(size_t vertex_count, size_t edge_count, unsigned seed) {
+	std::mt19937 generator(seed);
+	std::uniform_int_distribution<graph::VertexId> vertex(0, vertex_count - 1);
+	std::uniform_int_distribution<int> weight(1, 10);
+
+	graph::DirectedWeightedGraph<Weight> result(vertex_count);
+	for (size_t i = 0; i < edge_count; ++i) {
+		result.AddEdge({ vertex(generator), vertex(generator), static_cast<Weight>(weight(generator)) });
+	}
+	return result;
+}
+
+template <typename Weight, typename TableWeight>
+bool CompareTables(const char* name, size_t vertex_count, size_t edge_count, unsigned seed, size_t thread_count) {
+	const auto graph = MakeRandomGraph<Weight>(vertex_count, edge_count, seed);
+	graph::Router<Weight, TableWeight> router(graph, thread_count);
+	const auto simd_table = router.GetRoutesInternalData();
+	router.SetSimdEnabled(false);
+	router.Build();
+	const auto& scalar_table = router.GetRoutesInternalData();
+
+	if (simd_table.weights != scalar_table.weights || simd_table.prev_edges != scalar_table.prev_edges) {
+		std::cerr << name << ": " << vertex_count << " vertices, " << edge_count << " edges, seed " << seed
+			<< ", " << thread_count << " threads: the tables differ\n";
+		return false;
+	}
+	return true;
+}
+
+template <typename Weight, typename TableWeight>
+bool CompareAll(const char* name) {
+	bool ok = true;
+	for (size_t vertex_count : { 1, 3, 7, 65, 130, 257 }) {
+		for (unsigned seed = 1; seed <= 3; ++seed) {
+			for (size_t thread_count : { 1, 3 }) {
+				ok = CompareTables<Weight, TableWeight>(name, vertex_count, vertex_count * 3, seed, thread_count) && ok;
+			}
+		}
+	}
+	return ok;
+}
+
+template <typename Weight, typename TableWeight>
+void PrintBuildTimes(const char* name, size_t vertex_count) {
+	const auto graph = MakeRandomGraph<Weight>(vertex_count, vertex_count * 4, 1);
+	for (bool use_simd : { false, true }) {
+		graph::Router<Weight, TableWeight> router(graph);
+		router.SetSimdEnabled(use_simd);
+		const auto start = std::chrono::steady_clock::now();
+		router.Build();
+		const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+		std::cout << name << " " << vertex_count << " vertices, " << (use_simd ? "simd" : "scalar") << ": "
+			<< elapsed.count() << " ms\n";
+	}
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+	bool ok = CompareAll<double, double>("double");
+	ok = CompareAll<double, float>("float") && ok;
+	ok = CompareAll<uint32_t, uint32_t>("uint32") && ok;
+
+	if (argc > 1 && std::string(argv[1]) == "--benchmark") {
+		const size_t vertex_count = argc > 2 ? std::stoul(argv[2]) : 1000;
+		PrintBuildTimes<double, double>("double", vertex_count);
+		PrintBuildTimes<double, float>("float", vertex_count);
+	}
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
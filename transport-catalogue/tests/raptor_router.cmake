@@ -0,0 +1,43 @@
+# Checks that the RAPTOR engine can replace the graph engines: without bus_headways it finds the
+# same times, transfer limits included, and a bus with a headway is waited for that long
+
+include(${CMAKE_CURRENT_LIST_DIR}/test_helpers.cmake)
+
+set(STAT_REQUESTS [=[[
+        {"id": 1, "type": "Route", "from": "A", "to": "C"},
+        {"id": 2, "type": "Route", "from": "B", "to": "D"},
+        {"id": 3, "type": "Route", "from": "D", "to": "B"},
+        {"id": 4, "type": "Route", "from": "B", "to": "D", "max_transfers": 0},
+        {"id": 5, "type": "Route", "from": "D", "to": "B", "max_transfers": 0},
+        {"id": 6, "type": "Route", "from": "D", "to": "B", "max_transfers": 1},
+        {"id": 7, "type": "Route", "from": "C", "to": "B", "alternatives": 3}
+    ]]=])
+
+run_requests(expected ROUTER dijkstra BUS_WAIT_TIME 6 BUS_VELOCITY 30 STAT_REQUESTS "${STAT_REQUESTS}")
+run_requests(raptor ROUTER raptor BUS_WAIT_TIME 6 BUS_VELOCITY 30 STAT_REQUESTS "${STAT_REQUESTS}")
+get_total_times("${expected}" expected_times)
+get_total_times("${raptor}" raptor_times)
+if(NOT expected_times)
+    message(FATAL_ERROR "Dijkstra finds no routes:\n${expected}")
+endif()
+if(NOT raptor_times STREQUAL expected_times)
+    message(FATAL_ERROR "RAPTOR times differ from Dijkstra:\n${raptor}\nexpected:\n${expected}")
+endif()
+
+set(STAT_REQUESTS [=[[
+        {"id": 1, "type": "RouteMatrix", "from": ["A", "B", "C", "D"], "to": ["A", "B", "C", "D"]},
+        {"id": 2, "type": "Isochrone", "from": "B", "max_time": 30}
+    ]]=])
+
+run_requests(expected ROUTER dijkstra BUS_WAIT_TIME 6 BUS_VELOCITY 30 STAT_REQUESTS "${STAT_REQUESTS}")
+run_requests(raptor ROUTER raptor BUS_WAIT_TIME 6 BUS_VELOCITY 30 STAT_REQUESTS "${STAT_REQUESTS}")
+if(NOT expected MATCHES "total_times" OR NOT raptor STREQUAL expected)
+    message(FATAL_ERROR "RAPTOR route matrix or isochrone differs from Dijkstra:\n${raptor}\nexpected:\n${expected}")
+endif()
+
+run_requests(headway ROUTER raptor BUS_WAIT_TIME 6 BUS_VELOCITY 30
+    BASE_ROUTING_SETTINGS [=[, "bus_headways": {"1": 12}]=]
+    STAT_REQUESTS [=[[{"id": 1, "type": "Route", "from": "A", "to": "B"}]]=])
+if(NOT headway MATCHES "\"stop_name\": \"A\",[ \n]*\"time\": 12,")
+    message(FATAL_ERROR "RAPTOR does not wait the headway of bus 1:\n${headway}")
+endif()
@@ -0,0 +1,29 @@
+# Runs process_requests with routing_settings that give only some keys and checks that the
+# answers match a base built with the resulting settings
+
+include(${CMAKE_CURRENT_LIST_DIR}/test_helpers.cmake)
+
+foreach(router all_pairs dijkstra contraction_hierarchy raptor)
+    run_requests(expected ROUTER ${router} BUS_WAIT_TIME 6 BUS_VELOCITY 30)
+    if(NOT expected MATCHES "total_time" OR expected MATCHES "not found")
+        message(FATAL_ERROR "${router}: reference base finds no routes:\n${expected}")
+    endif()
+
+    run_requests(velocity_only ROUTER ${router} BUS_WAIT_TIME 6 BUS_VELOCITY 40
+        PROCESS_ROUTING_SETTINGS [=["routing_settings": {"bus_velocity": 30},]=])
+    if(NOT velocity_only STREQUAL expected)
+        message(FATAL_ERROR "${router}: bus_velocity override changed other settings:\n${velocity_only}\nexpected:\n${expected}")
+    endif()
+
+    run_requests(wait_time_only ROUTER ${router} BUS_WAIT_TIME 2 BUS_VELOCITY 30
+        PROCESS_ROUTING_SETTINGS [=["routing_settings": {"bus_wait_time": 6},]=])
+    if(NOT wait_time_only STREQUAL expected)
+        message(FATAL_ERROR "${router}: bus_wait_time override changed other settings:\n${wait_time_only}\nexpected:\n${expected}")
+    endif()
+
+    run_requests(rejected ROUTER ${router} BUS_WAIT_TIME 6 BUS_VELOCITY 30
+        PROCESS_ROUTING_SETTINGS [=["routing_settings": {"bus_velocity": 0},]=])
+    if(NOT rejected STREQUAL expected)
+        message(FATAL_ERROR "${router}: invalid bus_velocity override was applied:\n${rejected}\nexpected:\n${expected}")
+    endif()
+endforeach()
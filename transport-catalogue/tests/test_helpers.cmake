@@ -0,0 +1,80 @@
+# Shared by the script tests: a small base and a function running make_base and process_requests
+# on it. The scripts are invoked by ctest with -DTRANSPORT_CATALOGUE=<binary> -DWORK_DIR=<directory>.
+
+set(MAKE_BASE_TEMPLATE [=[
+{
+    "serialization_settings": {"file": "@BASE_FILE@"},
+    "routing_settings": {"bus_wait_time": @BUS_WAIT_TIME@, "bus_velocity": @BUS_VELOCITY@, "router": "@ROUTER@"@BASE_ROUTING_SETTINGS@},
+    "render_settings": {
+        "width": 600, "height": 400, "padding": 50, "stop_radius": 5, "line_width": 14,
+        "bus_label_font_size": 20, "bus_label_offset": [7, 15],
+        "stop_label_font_size": 20, "stop_label_offset": [7, -3],
+        "underlayer_color": [255, 255, 255, 0.85], "underlayer_width": 3,
+        "color_palette": ["green", [255, 160, 0], "red"]
+    },
+    "base_requests": [
+        {"type": "Stop", "name": "A", "latitude": 55.611087, "longitude": 37.20829, "road_distances": {"B": 3900, "C": 3000}},
+        {"type": "Stop", "name": "B", "latitude": 55.595884, "longitude": 37.209755, "road_distances": {"C": 2600}},
+        {"type": "Stop", "name": "C", "latitude": 55.632761, "longitude": 37.333324, "road_distances": {"D": 4650}},
+        {"type": "Stop", "name": "D", "latitude": 55.574371, "longitude": 37.6517, "road_distances": {"A": 7500}},
+        {"type": "Bus", "name": "1", "stops": ["A", "B", "C"], "is_roundtrip": false},
+        {"type": "Bus", "name": "2", "stops": ["C", "D", "A", "C"], "is_roundtrip": true}
+    ]
+}
+]=])
+
+set(PROCESS_REQUESTS_TEMPLATE [=[
+{
+    "serialization_settings": {"file": "@BASE_FILE@"},
+    @PROCESS_ROUTING_SETTINGS@
+    "stat_requests": @STAT_REQUESTS@
+}
+]=])
+
+set(DEFAULT_STAT_REQUESTS [=[[
+        {"id": 1, "type": "Route", "from": "A", "to": "C"},
+        {"id": 2, "type": "Route", "from": "B", "to": "D"},
+        {"id": 3, "type": "Route", "from": "D", "to": "B"}
+    ]]=])
+
+set(BASE_FILE "${WORK_DIR}/test_base.db")
+
+# run_requests(<result_var> ROUTER <router> BUS_WAIT_TIME <minutes> BUS_VELOCITY <km/h>
+#              [BASE_ROUTING_SETTINGS <json members>] [PROCESS_ROUTING_SETTINGS <json member>]
+#              [STAT_REQUESTS <json array>])
+# Builds a base with the given settings and stores the answer to the stat requests in result_var
+function(run_requests result_var)
+    cmake_parse_arguments(ARG "" "ROUTER;BUS_WAIT_TIME;BUS_VELOCITY;BASE_ROUTING_SETTINGS;PROCESS_ROUTING_SETTINGS;STAT_REQUESTS" "" ${ARGN})
+    set(ROUTER ${ARG_ROUTER})
+    set(BUS_WAIT_TIME ${ARG_BUS_WAIT_TIME})
+    set(BUS_VELOCITY ${ARG_BUS_VELOCITY})
+    set(BASE_ROUTING_SETTINGS "${ARG_BASE_ROUTING_SETTINGS}")
+    set(PROCESS_ROUTING_SETTINGS "${ARG_PROCESS_ROUTING_SETTINGS}")
+    set(STAT_REQUESTS "${DEFAULT_STAT_REQUESTS}")
+    if(ARG_STAT_REQUESTS)
+        set(STAT_REQUESTS "${ARG_STAT_REQUESTS}")
+    endif()
+
+    string(CONFIGURE "${MAKE_BASE_TEMPLATE}" make_base_request @ONLY)
+    string(CONFIGURE "${PROCESS_REQUESTS_TEMPLATE}" process_request @ONLY)
+    file(WRITE "${WORK_DIR}/make_base.json" "${make_base_request}")
+    file(WRITE "${WORK_DIR}/process_requests.json" "${process_request}")
+
+    execute_process(COMMAND ${TRANSPORT_CATALOGUE} make_base
+        INPUT_FILE "${WORK_DIR}/make_base.json" RESULT_VARIABLE status)
+    if(NOT status EQUAL 0)
+        message(FATAL_ERROR "make_base failed for ${ROUTER}")
+    endif()
+    execute_process(COMMAND ${TRANSPORT_CATALOGUE} process_requests
+        INPUT_FILE "${WORK_DIR}/process_requests.json" OUTPUT_VARIABLE output RESULT_VARIABLE status)
+    if(NOT status EQUAL 0)
+        message(FATAL_ERROR "process_requests failed for ${ROUTER}")
+    endif()
+    set(${result_var} "${output}" PARENT_SCOPE)
+endfunction()
+
+# Stores the total times of the answer, in order, in result_var
+function(get_total_times output result_var)
+    string(REGEX MATCHALL "\"total_time\": [^,\n]+" total_times "${output}")
+    set(${result_var} "${total_times}" PARENT_SCOPE)
+endfunction()
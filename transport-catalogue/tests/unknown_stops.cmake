@@ -0,0 +1,29 @@
+# Stats naming a stop missing from the catalogue are answered as not found instead of failing
+
+include(${CMAKE_CURRENT_LIST_DIR}/test_helpers.cmake)
+
+set(STAT_REQUESTS [=[[
+        {"id": 1, "type": "Route", "from": "nope", "to": "C"},
+        {"id": 2, "type": "Route", "from": "A", "to": "nope"},
+        {"id": 3, "type": "Route", "from": "A", "to": "C"},
+        {"id": 4, "type": "RouteMatrix", "from": ["nope", "A"], "to": ["C", "nope"]},
+        {"id": 5, "type": "Isochrone", "from": "nope", "max_time": 60},
+        {"id": 6, "type": "Route", "from": "nope", "to": "C", "max_transfers": 1},
+        {"id": 7, "type": "Route", "from": "A", "to": "nope", "alternatives": 2}
+    ]]=])
+
+foreach(router all_pairs dijkstra contraction_hierarchy a_star bidirectional_dijkstra raptor)
+    run_requests(output ROUTER ${router} BUS_WAIT_TIME 6 BUS_VELOCITY 30 STAT_REQUESTS "${STAT_REQUESTS}")
+    string(REGEX MATCHALL "\"not found\"" not_found "${output}")
+    list(LENGTH not_found not_found_count)
+    if(NOT not_found_count EQUAL 4 OR NOT output MATCHES "total_time")
+        message(FATAL_ERROR "${router}: unknown stops are not answered as not found:\n${output}")
+    endif()
+    string(REGEX REPLACE "[ \n]" "" compact_output "${output}")
+    if(NOT compact_output MATCHES "\"total_times\":\\[\\[null,null\\],\\[12,null\\]\\]")
+        message(FATAL_ERROR "${router}: route matrix rows and columns of unknown stops are not empty:\n${output}")
+    endif()
+    if(NOT compact_output MATCHES "\"items\":\\[\\],\"request_id\":5")
+        message(FATAL_ERROR "${router}: isochrone from an unknown stop is not empty:\n${output}")
+    endif()
+endforeach()
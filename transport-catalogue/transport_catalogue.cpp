@@ -7,22 +7,29 @@
 namespace transport_catalogue {
 
 void TransportCatalogue::AddBus(const Bus& bus) {
+	AddBus(bus, ComputeBusStats(&bus));
+}
+
+void TransportCatalogue::AddBus(const Bus& bus, const BusStats& stats) {
 	buses_.push_back(bus);
 
 	Bus* last_bus = &buses_.back();
+	last_bus->id = buses_.size() - 1;
 	buses_associative_.insert(BusDict::value_type(last_bus->name, last_bus));
 
 	for (Stop* stop : last_bus->stops) {
 		stop->buses.push_back(last_bus);
 	}
 
-	last_bus->route_length = GetRouteInfo(last_bus).distance;
+	last_bus->route_length = stats.route_length;
+	bus_stats_.push_back(stats);
 }
 
 void TransportCatalogue::AddStop(const Stop& stop) {
 	stops_.push_back(stop);
 
 	Stop* last_stop = &stops_.back();
+	last_stop->id = stops_.size() - 1;
 	stops_associative_.insert(StopDict::value_type(last_stop->name, last_stop));
 }
 
@@ -56,11 +63,11 @@ Stop* TransportCatalogue::GetStop(std::string_view stop_name) {
 	}
 }
 
-BusDict TransportCatalogue::GetBusesAssociative() const {
+const BusDict& TransportCatalogue::GetBusesAssociative() const {
 	return buses_associative_;
 }
 
-StopDict TransportCatalogue::GetStopsAssociative() const {
+const StopDict& TransportCatalogue::GetStopsAssociative() const {
 	return stops_associative_;
 }
 
@@ -74,6 +81,21 @@ Route TransportCatalogue::GetRouteInfo(const Bus* bus) const {
 	return result;
 }
 
+const BusStats& TransportCatalogue::GetBusStats(const Bus* bus) const {
+	return bus_stats_.at(bus->id);
+}
+
+BusStats TransportCatalogue::ComputeBusStats(const Bus* bus) const {
+	const Route route = GetRouteInfo(bus);
+
+	BusStats stats;
+	stats.unique_stop_count = static_cast<uint32_t>(route.unique_stops.size());
+	stats.route_length = route.distance;
+	stats.geo_length = route.length;
+	stats.curvature = static_cast<double>(route.distance) / route.length;
+	return stats;
+}
+
 std::unordered_set<const Bus*> TransportCatalogue::GetUniqueBuses(const Stop* stop) const {
 	std::unordered_set<const Bus*> unique_buses;
 
@@ -118,10 +140,14 @@ double TransportCatalogue::GetRouteLength(const Bus* bus) const {
 
 std::vector<detail::geo::Coordinates> TransportCatalogue::GetStopsCoordinates() const {
 	std::vector<detail::geo::Coordinates> result;
-	auto buses = GetBusesAssociative();
+	size_t stop_count = 0u;
+	for (const Bus& bus : buses_) {
+		stop_count += bus.stops.size();
+	}
+	result.reserve(stop_count);
 
-	for (auto& [name, bus] : buses) {
-		for (auto& stop : bus->stops) {
+	for (const auto& [name, bus] : buses_associative_) {
+		for (const auto& stop : bus->stops) {
 			detail::geo::Coordinates coordinates;
 			coordinates.lat = stop->coords.lat;
 			coordinates.lng = stop->coords.lng;
@@ -136,9 +162,9 @@ std::vector<detail::geo::Coordinates> TransportCatalogue::GetStopsCoordinates()
 std::vector<std::string_view> TransportCatalogue::GetSortedBusesNames() const {
 	std::vector<std::string_view> buses_names;
 
-	auto buses = GetBusesAssociative();
-	if (buses.size() > 0u) {
-		for (auto& [bus_name, bus] : buses) {
+	if (buses_associative_.size() > 0u) {
+		buses_names.reserve(buses_associative_.size());
+		for (const auto& [bus_name, bus] : buses_associative_) {
 			buses_names.push_back(bus_name);
 		}
 
@@ -157,10 +183,11 @@ BusQuery TransportCatalogue::GetBusQuery(std::string_view query) {
 	if (bus) {
 		result.name = bus->name;
 		result.query_exists = true;
+		const BusStats& stats = bus_stats_[bus->id];
 		result.route_stops = bus->stops.size();
-		result.unique_stops = GetRouteInfo(bus).unique_stops.size();
-		result.route_length = GetRouteInfo(bus).distance;
-		result.curvature = static_cast<double>(GetRouteInfo(bus).distance) / GetRouteInfo(bus).length;
+		result.unique_stops = stats.unique_stop_count;
+		result.route_length = stats.route_length;
+		result.curvature = stats.curvature;
 		return result;
 	}
 
@@ -213,15 +240,23 @@ size_t TransportCatalogue::GetDistanceBetweenStops(const Stop* from, const Stop*
 	return 0u;
 }
 
-std::deque<Stop> TransportCatalogue::GetStops() const {
+const Stop* TransportCatalogue::GetStopById(size_t stop_id) const {
+	return &stops_.at(stop_id);
+}
+
+size_t TransportCatalogue::GetStopCount() const {
+	return stops_.size();
+}
+
+const std::deque<Stop>& TransportCatalogue::GetStops() const {
 	return stops_;
 }
 
-std::deque<Bus> TransportCatalogue::GetBuses() const {
+const std::deque<Bus>& TransportCatalogue::GetBuses() const {
 	return buses_;
 }
 
-DistanceDict TransportCatalogue::GetDistances() const {
+const DistanceDict& TransportCatalogue::GetDistances() const {
 	return distances_;
 }
 
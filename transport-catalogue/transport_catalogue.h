@@ -39,16 +39,20 @@ using DistanceDict = std::unordered_map<std::pair<const Stop*, const Stop*>, int
 class TransportCatalogue {
 public:
     void AddBus(const Bus& bus);
+    // Adds a bus with stats computed before, as restored from a base
+    void AddBus(const Bus& bus, const BusStats& stats);
     void AddStop(const Stop& stop);
     void AddDistance(const Distance& distance);
 
     Bus* GetBus(std::string_view bus_name);
     Stop* GetStop(std::string_view stop_name);
+    const Stop* GetStopById(size_t stop_id) const;
 
-    BusDict GetBusesAssociative() const;
-    StopDict GetStopsAssociative() const;
+    const BusDict& GetBusesAssociative() const;
+    const StopDict& GetStopsAssociative() const;
 
     Route GetRouteInfo(const Bus* bus) const;
+    const BusStats& GetBusStats(const Bus* bus) const;
     std::unordered_set<const Bus*> GetUniqueBuses(const Stop* stop) const;
 
     std::vector<detail::geo::Coordinates> GetStopsCoordinates() const;
@@ -59,9 +63,10 @@ public:
 
     size_t GetDistanceBetweenStops(const Stop* from, const Stop* to) const;
 
-    std::deque<Stop> GetStops() const;
-    std::deque<Bus> GetBuses() const;
-    DistanceDict GetDistances() const;
+    size_t GetStopCount() const;
+    const std::deque<Stop>& GetStops() const;
+    const std::deque<Bus>& GetBuses() const;
+    const DistanceDict& GetDistances() const;
 
 private:
     std::deque<Stop> stops_;
@@ -69,12 +74,15 @@ private:
 
     std::deque<Bus> buses_;
     BusDict buses_associative_;
+    // Indexed by Bus::id
+    std::vector<BusStats> bus_stats_;
 
     DistanceDict distances_;
     
     std::unordered_set<const Stop*> GetUniqueStops(const Bus* bus) const;
     size_t GetRouteDistance(const Bus* bus) const;
     double GetRouteLength(const Bus* bus) const;
+    BusStats ComputeBusStats(const Bus* bus) const;
 };
 
 } // namespace transport_catalogue
\ No newline at end of file
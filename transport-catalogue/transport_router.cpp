@@ -6,45 +6,623 @@ namespace detail {
 
 namespace router {
 
-TransportRouter::TransportRouter(TransportCatalogue& catalogue, RoutingSettings routing_settings)
-	: routing_settings_(std::move(routing_settings)) {
+TransportRouter::TransportRouter(const TransportCatalogue& catalogue, RoutingSettings routing_settings)
+	: catalogue_(&catalogue)
+	, routing_settings_(std::move(routing_settings)) {
+	CheckRoutingSettings();
 	const auto stops = GetStopsPointers(catalogue);
+	stop_to_route_.resize(catalogue.GetStopCount());
+	const bool single_vertex = routing_settings_.graph_model == GraphModel::SINGLE_VERTEX;
 	size_t cnt = 0u;
 	for (const auto& stop : stops) {
 		VertexId bus_wait_start = cnt++;
-		VertexId bus_wait_end = cnt++;
-		stop_to_route_[stop] = WaitRange{ bus_wait_start, bus_wait_end };
+		VertexId bus_wait_end = single_vertex ? bus_wait_start : cnt++;
+		stop_to_route_[stop->id] = WaitRange{ bus_wait_start, bus_wait_end };
 	}
 
-	graph_ = std::make_unique<DirectedWeightedGraph<double>>(2 * stops.size());
-	AddEdgeToStops();
-	AddEdgeToBuses(catalogue);
+	// RAPTOR works on the stop sequences, its graph keeps the vertices only
+	graph_ = std::make_unique<DirectedWeightedGraph<double>>(cnt);
+	if (routing_settings_.router_type != RouterType::RAPTOR) {
+		if (!single_vertex) {
+			AddEdgeToStops(stops);
+		}
+		AddEdgeToBuses(catalogue);
+	}
+	FreezeGraph();
+
+	TransportRouterData data;
+	InitializeRouter(catalogue, data);
+}
+
+TransportRouter::TransportRouter(const TransportCatalogue& catalogue, RoutingSettings routing_settings, TransportRouterData data)
+	: stop_to_route_(std::move(data.stop_to_route))
+	, edge_id_to_edge_(std::move(data.edge_id_to_edge))
+	, graph_(std::make_unique<DirectedWeightedGraph<double>>(std::move(data.graph)))
+	, catalogue_(&catalogue)
+	, routing_settings_(std::move(routing_settings)) {
+	if (edge_id_to_edge_.size() != graph_->GetEdgeCount() || stop_to_route_.size() != catalogue.GetStopCount()) {
+		throw std::invalid_argument("Stored router does not match the catalogue");
+	}
+	CheckRoutingSettings();
+	FreezeGraph();
+	if (data.bus_wait_time != routing_settings_.bus_wait_time || data.bus_velocity != routing_settings_.bus_velocity) {
+		UpdateEdgeWeights();
+		data.routes_internal_data.reset();
+		data.compact_routes_internal_data.reset();
+		data.integer_routes_internal_data.reset();
+		data.contraction_hierarchy.reset();
+	}
+	InitializeRouter(catalogue, data);
+}
+
+void TransportRouter::FreezeGraph() {
+	const std::vector<EdgeId> new_ids = graph_->Freeze();
+
+	EdgeIdToEdge edge_id_to_edge(edge_id_to_edge_.size());
+	for (EdgeId edge_id = 0; edge_id < edge_id_to_edge_.size(); ++edge_id) {
+		edge_id_to_edge[new_ids[edge_id]] = std::move(edge_id_to_edge_[edge_id]);
+	}
+	edge_id_to_edge_ = std::move(edge_id_to_edge);
+}
+
+// One pass over the edges: waits come from the settings and rides from the stored distances.
+// Pruned parallel edges stay pruned, the velocity scales all rides between two stops alike.
+void TransportRouter::UpdateEdgeWeights() {
+	const bool single_vertex = routing_settings_.graph_model == GraphModel::SINGLE_VERTEX;
+	for (EdgeId edge_id = 0; edge_id < edge_id_to_edge_.size(); ++edge_id) {
+		auto& edge_info = edge_id_to_edge_[edge_id];
+		if (auto* stop_edge = std::get_if<StopEdge>(&edge_info)) {
+			stop_edge->time = routing_settings_.bus_wait_time;
+			graph_->SetEdgeWeight(edge_id, stop_edge->time);
+		}
+		else {
+			auto& bus_edge = std::get<BusEdge>(edge_info);
+			bus_edge.time = ComputeRideTime(bus_edge.distance);
+			graph_->SetEdgeWeight(edge_id, single_vertex ? bus_edge.time + routing_settings_.bus_wait_time : bus_edge.time);
+		}
+	}
+	weights_updated_ = true;
+}
+
+void TransportRouter::InitializeRouter(const TransportCatalogue& catalogue, TransportRouterData& data) {
+	// Needs no preprocessing, so it is kept for every engine to serve isochrones
+	dijkstra_router_ = std::make_unique<DijkstraRouter<double>>(*graph_);
+
+	if (routing_settings_.route_cache_size > 0) {
+		route_cache_ = std::make_unique<RouteCache>(routing_settings_.route_cache_size);
+	}
+
+	if (routing_settings_.graph_model == GraphModel::SINGLE_VERTEX) {
+		boarding_stop_names_.resize(graph_->GetVertexCount());
+		for (size_t stop_id = 0; stop_id < catalogue.GetStopCount(); ++stop_id) {
+			boarding_stop_names_[stop_to_route_[stop_id].bus_wait_end] = catalogue.GetStopById(stop_id)->name;
+		}
+	}
+
+	switch (routing_settings_.router_type) {
+	case RouterType::ALL_PAIRS:
+		InitializeAllPairsRouter(data);
+		break;
+	case RouterType::DIJKSTRA:
+		if (routing_settings_.integer_weights && InitializeIntegerGraph()) {
+			integer_dijkstra_router_ = std::make_unique<DijkstraRouter<uint32_t>>(*integer_graph_);
+		}
+		break;
+	case RouterType::BIDIRECTIONAL_DIJKSTRA:
+		break;
+	case RouterType::CONTRACTION_HIERARCHY:
+		if (data.contraction_hierarchy && ContractionHierarchy<double>::IsCompatible(*graph_, *data.contraction_hierarchy)) {
+			contraction_hierarchy_ = std::make_unique<ContractionHierarchy<double>>(*graph_, std::move(*data.contraction_hierarchy));
+		}
+		else {
+			contraction_hierarchy_ = std::make_unique<ContractionHierarchy<double>>(*graph_);
+		}
+		break;
+	case RouterType::A_STAR:
+		InitializeGeoHeuristic(catalogue);
+		break;
+	case RouterType::RAPTOR:
+		raptor_router_ = std::make_unique<RaptorRouter>(catalogue, routing_settings_);
+		break;
+	}
+
+	InitializeComponents(data);
+}
+
+void TransportRouter::InitializeComponents(TransportRouterData& data) {
+	if (data.strong_components.size() == stop_to_route_.size() && data.weak_components.size() == stop_to_route_.size()) {
+		strong_components_ = std::move(data.strong_components);
+		weak_components_ = std::move(data.weak_components);
+		return;
+	}
+
+	if (raptor_router_) {
+		const auto stop_graph = raptor_router_->MakeStopGraph();
+		strong_components_ = ComputeStrongComponents(stop_graph);
+		weak_components_ = ComputeWeakComponents(stop_graph);
+		return;
+	}
+
+	const auto strong_components = ComputeStrongComponents(*graph_);
+	const auto weak_components = ComputeWeakComponents(*graph_);
+	strong_components_.resize(stop_to_route_.size());
+	weak_components_.resize(stop_to_route_.size());
+	for (size_t stop_id = 0; stop_id < stop_to_route_.size(); ++stop_id) {
+		strong_components_[stop_id] = strong_components[stop_to_route_[stop_id].bus_wait_start];
+		weak_components_[stop_id] = weak_components[stop_to_route_[stop_id].bus_wait_start];
+	}
+}
+
+bool TransportRouter::MayReach(const Stop* from, const Stop* to) const {
+	// Nothing is reachable from or to a stop missing from the catalogue
+	if (!GetRouteAtStop(from) || !GetRouteAtStop(to)) {
+		return false;
+	}
+	// Strong components are numbered so that edges never lead to a greater id
+	return weak_components_[from->id] == weak_components_[to->id]
+		&& strong_components_[from->id] >= strong_components_[to->id];
+}
 
-	router_ = std::make_unique<Router<double>>(*graph_);
-	router_->Build();
+void TransportRouter::InitializeAllPairsRouter(TransportRouterData& data) {
+	if (routing_settings_.integer_weights && InitializeIntegerGraph()) {
+		if (data.integer_routes_internal_data) {
+			integer_router_ = std::make_unique<Router<uint32_t>>(*integer_graph_, std::move(*data.integer_routes_internal_data));
+		}
+		else {
+			integer_router_ = std::make_unique<Router<uint32_t>>(*integer_graph_, routing_settings_.thread_count);
+		}
+		return;
+	}
+
+	switch (routing_settings_.routes_table_layout) {
+	case RoutesTableLayout::WIDE:
+		if (data.routes_internal_data) {
+			router_ = std::make_unique<Router<double>>(*graph_, std::move(*data.routes_internal_data));
+		}
+		else {
+			router_ = std::make_unique<Router<double>>(*graph_, routing_settings_.thread_count);
+		}
+		break;
+	case RoutesTableLayout::COMPACT:
+		if (data.compact_routes_internal_data) {
+			compact_router_ = std::make_unique<Router<double, float>>(*graph_, std::move(*data.compact_routes_internal_data));
+		}
+		else {
+			compact_router_ = std::make_unique<Router<double, float>>(*graph_, routing_settings_.thread_count);
+		}
+		break;
+	}
+}
+
+bool TransportRouter::InitializeIntegerGraph() {
+	// A shortest route is simple, so it weighs no more than all edges together nor than
+	// (vertex count - 1) of the heaviest one. Relaxation adds two such routes, or a route and an
+	// edge, and the sum must stay below the weight marking a missing route.
+	const uint64_t max_units = std::numeric_limits<uint32_t>::max();
+	uint64_t total_units = 0;
+	uint64_t max_edge_units = 0;
+	std::vector<uint32_t> edge_units(graph_->GetEdgeCount());
+	for (EdgeId edge_id = 0; edge_id < graph_->GetEdgeCount(); ++edge_id) {
+		const double units = std::round(graph_->GetEdge(edge_id).weight * FIXED_POINT_UNITS_PER_MINUTE);
+		if (!(units >= 0 && units < max_units)) {
+			return false;
+		}
+		edge_units[edge_id] = static_cast<uint32_t>(units);
+		total_units = std::min(total_units + edge_units[edge_id], max_units);
+		max_edge_units = std::max<uint64_t>(max_edge_units, edge_units[edge_id]);
+	}
+	const uint64_t vertex_count = graph_->GetVertexCount();
+	const uint64_t route_bound = std::min(total_units, vertex_count > 0 ? (vertex_count - 1) * max_edge_units : 0);
+	if (2 * route_bound >= max_units) {
+		return false;
+	}
+
+	integer_graph_ = std::make_unique<DirectedWeightedGraph<uint32_t>>(graph_->GetVertexCount());
+	for (EdgeId edge_id = 0; edge_id < graph_->GetEdgeCount(); ++edge_id) {
+		const auto& edge = graph_->GetEdge(edge_id);
+		integer_graph_->AddEdge(Edge<uint32_t>{ edge.from, edge.to, edge_units[edge_id] });
+	}
+
+	// Edges of the frozen graph are already grouped by origin, so freezing keeps their ids
+	const std::vector<EdgeId> new_ids = integer_graph_->Freeze();
+	for (EdgeId edge_id = 0; edge_id < new_ids.size(); ++edge_id) {
+		if (new_ids[edge_id] != edge_id) {
+			throw std::logic_error("Fixed-point graph does not keep edge ids");
+		}
+	}
+	return true;
+}
+
+std::optional<RouteInfo<double>> TransportRouter::ToMinutes(std::optional<RouteInfo<uint32_t>> route_info) const {
+	if (!route_info) {
+		return std::nullopt;
+	}
+
+	double weight = 0.0;
+	for (const EdgeId edge_id : route_info->edges) {
+		weight += graph_->GetEdge(edge_id).weight;
+	}
+	return RouteInfo<double>{ weight, std::move(route_info->edges) };
+}
+
+void TransportRouter::InitializeGeoHeuristic(const TransportCatalogue& catalogue) {
+	vertex_coordinates_.resize(graph_->GetVertexCount());
+	for (const auto& [_, stop] : catalogue.GetStopsAssociative()) {
+		const WaitRange& route = stop_to_route_.at(stop->id);
+		vertex_coordinates_[route.bus_wait_start] = stop->coords;
+		vertex_coordinates_[route.bus_wait_end] = stop->coords;
+	}
+
+	// The bound needs road distances to be no shorter than great-circle ones. Any edge breaking
+	// that lowers the scale to what the base allows, down to plain Dijkstra if nothing is left.
+	const double meters_per_minute = routing_settings_.bus_velocity * 1000 / 60;
+	geo_heuristic_scale_ = meters_per_minute > 0 ? 1.0 : 0.0;
+	for (EdgeId edge_id = 0; edge_id < graph_->GetEdgeCount() && geo_heuristic_scale_ > 0; ++edge_id) {
+		const auto& edge = graph_->GetEdge(edge_id);
+		const double geo_distance = geo::ComputeDistance(vertex_coordinates_[edge.from], vertex_coordinates_[edge.to]);
+		if (geo_distance > 0) {
+			geo_heuristic_scale_ = std::min(geo_heuristic_scale_, edge.weight * meters_per_minute / geo_distance);
+		}
+	}
+	geo_heuristic_scale_ /= meters_per_minute > 0 ? meters_per_minute : 1.0;
+}
+
+double TransportRouter::ComputeGeoHeuristic(VertexId from, VertexId to) const {
+	if (geo_heuristic_scale_ <= 0) {
+		return 0.0;
+	}
+	return geo::ComputeDistance(vertex_coordinates_[from], vertex_coordinates_[to]) * geo_heuristic_scale_;
+}
+
+void TransportRouter::PrintStats(std::ostream& output) const {
+	const size_t vertex_count = graph_->GetVertexCount();
+
+	output << "Routing graph: " << vertex_count << " vertices, " << graph_->GetEdgeCount() << " edges\n";
+	output << "Components among stops: "
+		<< std::unordered_set<size_t>(strong_components_.begin(), strong_components_.end()).size() << " strong, "
+		<< std::unordered_set<size_t>(weak_components_.begin(), weak_components_.end()).size() << " weak\n";
+	if (weights_updated_) {
+		output << "Edge weights recomputed for the new wait time and velocity\n";
+	}
+	if (bus_edge_counts_) {
+		output << "Bus edges: " << bus_edge_counts_->first << " generated, " << bus_edge_counts_->second
+			<< " kept after pruning parallel edges\n";
+	}
+
+	if (routing_settings_.router_type == RouterType::ALL_PAIRS) {
+		const size_t allocated = router_ ? router_->GetMemoryUsage()
+			: compact_router_ ? compact_router_->GetMemoryUsage() : integer_router_->GetMemoryUsage();
+		output << "All-pairs table: " << allocated << " bytes allocated"
+			<< ", wide layout " << Router<double>::GetMemoryUsage(vertex_count) << " bytes"
+			<< ", compact layout " << Router<double, float>::GetMemoryUsage(vertex_count) << " bytes"
+			<< ", fixed-point layout " << Router<uint32_t>::GetMemoryUsage(vertex_count) << " bytes\n";
+	}
+
+	if (raptor_router_) {
+		output << "RAPTOR: " << raptor_router_->GetRouteCount() << " bus directions, "
+			<< raptor_router_->GetRouteStopCount() << " stops along them\n";
+	}
+
+	if (routing_settings_.router_type == RouterType::A_STAR) {
+		output << "A* heuristic: " << geo_heuristic_scale_ * routing_settings_.bus_velocity * 1000 / 60
+			<< " of the great-circle travel time" << (geo_heuristic_scale_ > 0 ? "\n" : ", falling back to Dijkstra\n");
+	}
+}
+
+const StopToRoute& TransportRouter::GetStopToRoute() const {
+	return stop_to_route_;
+}
+
+const EdgeIdToEdge& TransportRouter::GetEdgeIdToEdge() const {
+	return edge_id_to_edge_;
+}
+
+const DirectedWeightedGraph<double>& TransportRouter::GetGraph() const {
+	return *graph_;
+}
+
+const Router<double>* TransportRouter::GetRouter() const {
+	return router_.get();
+}
+
+const Router<double, float>* TransportRouter::GetCompactRouter() const {
+	return compact_router_.get();
+}
+
+const Router<uint32_t>* TransportRouter::GetIntegerRouter() const {
+	return integer_router_.get();
+}
+
+const ContractionHierarchy<double>* TransportRouter::GetContractionHierarchy() const {
+	return contraction_hierarchy_.get();
+}
+
+const std::vector<size_t>& TransportRouter::GetStrongComponents() const {
+	return strong_components_;
+}
+
+const std::vector<size_t>& TransportRouter::GetWeakComponents() const {
+	return weak_components_;
+}
+
+std::optional<cache::CacheStats> TransportRouter::GetRouteCacheStats() const {
+	if (route_cache_) {
+		return route_cache_->GetStats();
+	}
+	return std::nullopt;
 }
 
 const std::variant<StopEdge, BusEdge>& TransportRouter::GetEdgeAt(EdgeId id) const {
-	return edge_id_to_edge_.at(id);
+	return edge_id_to_edge_[id];
 }
 
-std::optional<WaitRange> TransportRouter::GetRouteAtStop(Stop* stop) const {
-	if (stop_to_route_.count(stop)) {
-		return stop_to_route_.at(stop);
+std::optional<WaitRange> TransportRouter::GetRouteAtStop(const Stop* stop) const {
+	if (stop && stop->id < stop_to_route_.size()) {
+		return stop_to_route_[stop->id];
 	}
 	
 	return std::nullopt;
 }
 
+std::optional<RouteInfo<double>> TransportRouter::BuildRoute(VertexId from, VertexId to) const {
+	switch (routing_settings_.router_type) {
+	case RouterType::ALL_PAIRS:
+		if (integer_router_) {
+			return ToMinutes(integer_router_->BuildRoute(from, to));
+		}
+		return router_ ? router_->BuildRoute(from, to) : compact_router_->BuildRoute(from, to);
+	case RouterType::DIJKSTRA:
+		if (integer_dijkstra_router_) {
+			return ToMinutes(integer_dijkstra_router_->BuildRoute(from, to));
+		}
+		return dijkstra_router_->BuildRoute(from, to);
+	case RouterType::CONTRACTION_HIERARCHY:
+		return contraction_hierarchy_->BuildRoute(from, to);
+	case RouterType::A_STAR:
+		return dijkstra_router_->BuildRoute(from, to, [this, to](VertexId vertex) {
+			return ComputeGeoHeuristic(vertex, to);
+		});
+	case RouterType::BIDIRECTIONAL_DIJKSTRA:
+		return dijkstra_router_->BuildBidirectionalRoute(from, to);
+	case RouterType::RAPTOR:
+		// Answered by stops in GetRouteGraphInfos, the graph has no headways
+		break;
+	}
+
+	return std::nullopt;
+}
+
+std::optional<double> TransportRouter::GetRouteWeight(VertexId from, VertexId to) const {
+	if (router_) {
+		return router_->GetRouteWeight(from, to);
+	}
+	if (compact_router_) {
+		return compact_router_->GetRouteWeight(from, to);
+	}
+	if (const auto route_info = BuildRoute(from, to)) {
+		return route_info->weight;
+	}
+	return std::nullopt;
+}
+
 std::optional<RouteGraphInfo> TransportRouter::GetRouteGraphInfo(Stop* from, Stop* to) const {
-	const auto route_info = router_->BuildRoute(GetRouteAtStop(from)->bus_wait_start, GetRouteAtStop(to)->bus_wait_start);
-	
+	return std::move(GetRouteGraphInfos(from, { to }).front());
+}
+
+std::vector<std::optional<RouteGraphInfo>> TransportRouter::GetRouteGraphInfos(const Stop* from, const std::vector<const Stop*>& destinations) const {
+	// Stops missing from the catalogue have no route
+	const auto from_route = GetRouteAtStop(from);
+	if (!from_route) {
+		return std::vector<std::optional<RouteGraphInfo>>(destinations.size());
+	}
+
+	std::vector<std::optional<RouteGraphInfo>> result;
+	result.reserve(destinations.size());
+
+	// The all-pairs table and the hierarchy answer each pair directly, a single destination
+	// is cheaper with a search that stops at it. The tree is built on the first cache miss.
+	const bool use_tree = !router_ && !compact_router_ && !integer_router_ && !contraction_hierarchy_ && destinations.size() > 1;
+	const VertexId from_vertex = from_route->bus_wait_start;
+	std::optional<DijkstraRouter<double>::ShortestPathTree> tree;
+	std::optional<DijkstraRouter<uint32_t>::ShortestPathTree> integer_tree;
+	std::optional<RaptorRouter::Labels> raptor_labels;
+
+	auto build_route = [&](const Stop* to) -> std::optional<RouteGraphInfo> {
+		if (raptor_router_) {
+			if (!MayReach(from, to)) {
+				return std::nullopt;
+			}
+			if (!raptor_labels) {
+				raptor_labels = raptor_router_->Search(from->id, destinations.size() > 1 ? std::nullopt : std::optional<size_t>(to->id));
+			}
+			return raptor_router_->BuildRoute(*raptor_labels, to->id);
+		}
+
+		const VertexId to_vertex = GetRouteAtStop(to)->bus_wait_start;
+		if (!use_tree) {
+			return MayReach(from, to) ? MakeRouteGraphInfo(BuildRoute(from_vertex, to_vertex)) : std::nullopt;
+		}
+		if (integer_dijkstra_router_) {
+			if (!integer_tree) {
+				integer_tree = integer_dijkstra_router_->BuildShortestPathTree(from_vertex);
+			}
+			return MakeRouteGraphInfo(ToMinutes(integer_dijkstra_router_->BuildRoute(*integer_tree, to_vertex)));
+		}
+		if (!tree) {
+			tree = dijkstra_router_->BuildShortestPathTree(from_vertex);
+		}
+		return MakeRouteGraphInfo(dijkstra_router_->BuildRoute(*tree, to_vertex));
+	};
+
+	for (const Stop* to : destinations) {
+		if (!GetRouteAtStop(to)) {
+			result.emplace_back();
+			continue;
+		}
+		if (!route_cache_) {
+			result.push_back(build_route(to));
+			continue;
+		}
+		if (auto cached = route_cache_->Get({ from, to })) {
+			result.push_back(std::move(*cached));
+			continue;
+		}
+		result.push_back(build_route(to));
+		route_cache_->Put({ from, to }, result.back());
+	}
+	return result;
+}
+
+std::optional<RouteGraphInfo> TransportRouter::GetLimitedRouteGraphInfo(const Stop* from, const Stop* to, size_t max_transfers) const {
+	if (!MayReach(from, to)) {
+		return std::nullopt;
+	}
+
+	if (raptor_router_) {
+		return raptor_router_->BuildRoute(raptor_router_->Search(from->id, to->id, std::nullopt, max_transfers + 1), to->id);
+	}
+
+	const auto from_route = GetRouteAtStop(from);
+	const auto to_route = GetRouteAtStop(to);
+	if (!from_route || !to_route) {
+		return std::nullopt;
+	}
+	const auto is_ride = [this](EdgeId edge_id) {
+		return std::holds_alternative<BusEdge>(edge_id_to_edge_[edge_id]);
+	};
+	return MakeRouteGraphInfo(dijkstra_router_->BuildLimitedRoute(from_route->bus_wait_start, to_route->bus_wait_start, is_ride, max_transfers + 1));
+}
+
+std::vector<RouteGraphInfo> TransportRouter::GetAlternativeRouteGraphInfos(const Stop* from, const Stop* to, size_t count) const {
+	std::vector<RouteGraphInfo> result;
+	if (!MayReach(from, to)) {
+		return result;
+	}
+
+	if (raptor_router_) {
+		std::call_once(graph_router_built_, [this]() {
+			RoutingSettings routing_settings = routing_settings_;
+			routing_settings.router_type = RouterType::DIJKSTRA;
+			routing_settings.integer_weights = false;
+			routing_settings.route_cache_size = 0;
+			graph_router_ = std::make_unique<TransportRouter>(*catalogue_, std::move(routing_settings));
+		});
+		return graph_router_->GetAlternativeRouteGraphInfos(from, to, count);
+	}
+
+	const auto from_route = GetRouteAtStop(from);
+	const auto to_route = GetRouteAtStop(to);
+	if (!from_route || !to_route) {
+		return result;
+	}
+	const SearchBudget budget{ routing_settings_.alternatives_max_searches, std::chrono::milliseconds(routing_settings_.alternatives_max_milliseconds) };
+	for (auto& route_info : BuildAlternativeRoutes(*graph_, *dijkstra_router_, from_route->bus_wait_start, to_route->bus_wait_start, count, budget)) {
+		result.push_back(*MakeRouteGraphInfo(std::move(route_info)));
+	}
+	return result;
+}
+
+RouteMatrix TransportRouter::GetRouteMatrix(const std::vector<const Stop*>& origins, const std::vector<const Stop*>& destinations) const {
+	// Rows and columns of stops missing from the catalogue stay empty, the others are computed
+	// over the known stops only
+	std::vector<size_t> rows;
+	std::vector<VertexId> sources;
+	for (size_t i = 0; i < origins.size(); ++i) {
+		if (const auto route = GetRouteAtStop(origins[i])) {
+			rows.push_back(i);
+			sources.push_back(route->bus_wait_start);
+		}
+	}
+	std::vector<size_t> columns;
+	std::vector<VertexId> targets;
+	for (size_t j = 0; j < destinations.size(); ++j) {
+		if (const auto route = GetRouteAtStop(destinations[j])) {
+			columns.push_back(j);
+			targets.push_back(route->bus_wait_start);
+		}
+	}
+
+	RouteMatrix known_result;
+	if (contraction_hierarchy_) {
+		known_result = contraction_hierarchy_->BuildWeightMatrix(sources, targets);
+	}
+	else if (raptor_router_) {
+		for (const size_t i : rows) {
+			const auto labels = raptor_router_->Search(origins[i]->id);
+			auto& row = known_result.emplace_back();
+			for (const size_t j : columns) {
+				row.push_back(raptor_router_->GetArrivalTime(labels, destinations[j]->id));
+			}
+		}
+	}
+	else {
+		known_result.assign(sources.size(), std::vector<std::optional<double>>(targets.size()));
+		for (size_t i = 0; i < sources.size(); ++i) {
+			if (router_ || compact_router_ || integer_router_) {
+				for (size_t j = 0; j < targets.size(); ++j) {
+					known_result[i][j] = GetRouteWeight(sources[i], targets[j]);
+				}
+			}
+			else {
+				const auto tree = dijkstra_router_->BuildShortestPathTree(sources[i]);
+				for (size_t j = 0; j < targets.size(); ++j) {
+					known_result[i][j] = tree.weights[targets[j]];
+				}
+			}
+		}
+	}
+
+	RouteMatrix result(origins.size(), std::vector<std::optional<double>>(destinations.size()));
+	for (size_t i = 0; i < rows.size(); ++i) {
+		for (size_t j = 0; j < columns.size(); ++j) {
+			result[rows[i]][columns[j]] = known_result[i][j];
+		}
+	}
+	return result;
+}
+
+std::vector<std::pair<size_t, double>> TransportRouter::GetIsochrone(const Stop* from, double max_time) const {
+	// A stop missing from the catalogue reaches nothing
+	const auto from_route = GetRouteAtStop(from);
+	if (!from_route) {
+		return {};
+	}
+
+	if (raptor_router_) {
+		const auto labels = raptor_router_->Search(from->id, std::nullopt, max_time);
+		std::vector<std::pair<size_t, double>> result;
+		for (size_t stop_id = 0; stop_id < stop_to_route_.size(); ++stop_id) {
+			if (const auto time = raptor_router_->GetArrivalTime(labels, stop_id)) {
+				result.emplace_back(stop_id, *time);
+			}
+		}
+		return result;
+	}
+
+	const auto tree = dijkstra_router_->BuildShortestPathTree(from_route->bus_wait_start, max_time);
+
+	// A stop is reached once its boarding vertex is, before waiting for a bus there
+	std::vector<std::pair<size_t, double>> result;
+	for (size_t stop_id = 0; stop_id < stop_to_route_.size(); ++stop_id) {
+		if (const auto& time = tree.weights[stop_to_route_[stop_id].bus_wait_start]) {
+			result.emplace_back(stop_id, *time);
+		}
+	}
+	return result;
+}
+
+std::optional<RouteGraphInfo> TransportRouter::MakeRouteGraphInfo(const std::optional<RouteInfo<double>>& route_info) const {
 	if (route_info) {
 		RouteGraphInfo result;
 		result.total_time = route_info->weight;
 
 		for (const auto& edge : route_info->edges) {
-			result.edges.emplace_back(GetEdgeAt(edge));
+			const auto& edge_info = GetEdgeAt(edge);
+			// A bus edge of the single-vertex graph includes the wait before boarding
+			if (routing_settings_.graph_model == GraphModel::SINGLE_VERTEX && std::holds_alternative<BusEdge>(edge_info)) {
+				result.edges.emplace_back(StopEdge{ boarding_stop_names_[graph_->GetEdge(edge).from], routing_settings_.bus_wait_time });
+			}
+			result.edges.emplace_back(edge_info);
 		}
 
 		return result;
@@ -53,53 +631,115 @@ std::optional<RouteGraphInfo> TransportRouter::GetRouteGraphInfo(Stop* from, Sto
 	return std::nullopt;
 }
 
-std::deque<Stop*> TransportRouter::GetStopsPointers(TransportCatalogue& catalogue) const {
+std::deque<Stop*> TransportRouter::GetStopsPointers(const TransportCatalogue& catalogue) const {
 	std::deque<Stop*> result;
 
 	for (const auto& [_, stop_ptr] : catalogue.GetStopsAssociative()) {
 		result.push_back(stop_ptr);
 	}
 
+	// Vertex and edge ids must not depend on hash order: preprocessed data in the base refers to them
+	std::sort(result.begin(), result.end(), [](const Stop* lhs, const Stop* rhs) {
+		return lhs->name < rhs->name;
+	});
+
 	return result;
 }
 
-std::deque<Bus*> TransportRouter::GetBusesPointers(TransportCatalogue& catalogue) const {
+std::deque<Bus*> TransportRouter::GetBusesPointers(const TransportCatalogue& catalogue) const {
 	std::deque<Bus*> result;
 
 	for (const auto& [_, bus_ptr] : catalogue.GetBusesAssociative()) {
 		result.push_back(bus_ptr);
 	}
 
+	std::sort(result.begin(), result.end(), [](const Bus* lhs, const Bus* rhs) {
+		return lhs->name < rhs->name;
+	});
+
 	return result;
 }
 
-void TransportRouter::AddEdgeToStops() {
-	for (const auto& [stop, route] : stop_to_route_) {
-		EdgeId id = graph_->AddEdge(Edge<double> {route.bus_wait_start, route.bus_wait_end, routing_settings_.bus_wait_time});
-		edge_id_to_edge_[id] = StopEdge{ stop->name, routing_settings_.bus_wait_time };
+void TransportRouter::AddEdgeToStops(const std::deque<Stop*>& stops) {
+	for (Stop* stop : stops) {
+		const WaitRange& route = stop_to_route_[stop->id];
+		graph_->AddEdge(Edge<double> {route.bus_wait_start, route.bus_wait_end, routing_settings_.bus_wait_time});
+		edge_id_to_edge_.emplace_back(StopEdge{ stop->name, routing_settings_.bus_wait_time });
 	}
 }
 
-void TransportRouter::AddEdgeToBuses(TransportCatalogue& catalogue) {
+void TransportRouter::AddEdgeToBuses(const TransportCatalogue& catalogue) {
+	BusEdges bus_edges;
 	for (const auto& bus : GetBusesPointers(catalogue)) {
-		MakeEdgesFromBuses(bus->stops.begin(), bus->stops.end(), bus, catalogue);
+		MakeEdgesFromBuses(bus->stops.begin(), bus->stops.end(), bus, catalogue, bus_edges);
 
 		if (!bus->is_roundtrip) {
-			MakeEdgesFromBuses(bus->stops.rbegin(), bus->stops.rend(), bus, catalogue);
+			MakeEdgesFromBuses(bus->stops.rbegin(), bus->stops.rend(), bus, catalogue, bus_edges);
 		}
 	}
+
+	const size_t generated_count = bus_edges.size();
+	PruneDominatedEdges(bus_edges);
+	bus_edge_counts_ = std::make_pair(generated_count, bus_edges.size());
+
+	for (auto& [edge, bus_edge] : bus_edges) {
+		graph_->AddEdge(edge);
+		edge_id_to_edge_.emplace_back(std::move(bus_edge));
+	}
+}
+
+// Of parallel edges between the same pair of vertices only the cheapest can be part of a
+// shortest route. On ties the earliest one stays, the same edge a search would settle on.
+void TransportRouter::PruneDominatedEdges(BusEdges& bus_edges) const {
+	const size_t vertex_count = graph_->GetVertexCount();
+	std::unordered_map<size_t, size_t> cheapest_edges;
+	std::vector<bool> is_kept(bus_edges.size(), false);
+
+	for (size_t index = 0; index < bus_edges.size(); ++index) {
+		const Edge<double>& edge = bus_edges[index].first;
+		const auto [it, inserted] = cheapest_edges.emplace(edge.from * vertex_count + edge.to, index);
+		if (inserted) {
+			is_kept[index] = true;
+		}
+		else if (edge.weight < bus_edges[it->second].first.weight) {
+			is_kept[it->second] = false;
+			is_kept[index] = true;
+			it->second = index;
+		}
+	}
+
+	size_t kept_count = 0;
+	for (size_t index = 0; index < bus_edges.size(); ++index) {
+		if (is_kept[index]) {
+			bus_edges[kept_count++] = std::move(bus_edges[index]);
+		}
+	}
+	bus_edges.resize(kept_count);
 }
 
 Edge<double> TransportRouter::CreateRouteFromStops(Stop* start, Stop* end, const double distance) const {
 	Edge<double> result;
 
-	result.from = stop_to_route_.at(start).bus_wait_end;
-	result.to = stop_to_route_.at(end).bus_wait_start;
-	result.weight = distance * 1.0 / (routing_settings_.bus_velocity * 1000 / 60);
+	result.from = stop_to_route_[start->id].bus_wait_end;
+	result.to = stop_to_route_[end->id].bus_wait_start;
+	result.weight = ComputeRideTime(distance);
 
 	return result;
 }
 
+void TransportRouter::CheckRoutingSettings() const {
+	if (!(routing_settings_.bus_velocity > 0)) {
+		throw std::invalid_argument("Routing settings need a positive bus_velocity");
+	}
+	if (!(routing_settings_.bus_wait_time >= 0)) {
+		throw std::invalid_argument("Routing settings need a non-negative bus_wait_time");
+	}
+}
+
+double TransportRouter::ComputeRideTime(double distance) const {
+	return distance * 1.0 / (routing_settings_.bus_velocity * 1000 / 60);
+}
+
 } // namespace router
 
 } // namespace detail
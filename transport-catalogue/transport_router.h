@@ -1,11 +1,26 @@
 #pragma once
 
+#include "alternative_routes.h"
+#include "contraction_hierarchy.h"
+#include "dijkstra_router.h"
 #include "domain.h"
+#include "geo.h"
 #include "graph.h"
+#include "graph_components.h"
+#include "lru_cache.h"
+#include "raptor_router.h"
 #include "router.h"
 #include "transport_catalogue.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_set>
 #include <variant>
 
 namespace transport_catalogue {
@@ -17,38 +32,146 @@ namespace router {
 using namespace domain;
 using namespace graph;
 
+// Indexed by Stop::id
+using StopToRoute = std::vector<WaitRange>;
+// Indexed by the id of the graph edge
+using EdgeIdToEdge = std::vector<std::variant<StopEdge, BusEdge>>;
+
+// State built by TransportRouter from the catalogue, restored from the base in process_requests
+struct TransportRouterData {
+	StopToRoute stop_to_route;
+	EdgeIdToEdge edge_id_to_edge;
+	DirectedWeightedGraph<double> graph;
+	std::optional<Router<double>::RoutesInternalData> routes_internal_data;
+	std::optional<Router<double, float>::RoutesInternalData> compact_routes_internal_data;
+	std::optional<Router<uint32_t>::RoutesInternalData> integer_routes_internal_data;
+	std::optional<ContractionHierarchyData<double>> contraction_hierarchy;
+	// Indexed by Stop::id. Bases written before components were stored restore them as zeros,
+	// which only disables the early not-found answers.
+	std::vector<size_t> strong_components;
+	std::vector<size_t> weak_components;
+	// Settings the stored weights were computed with. Other wait or velocity settings re-derive
+	// the weights from the edges and drop the preprocessing, the topology is kept.
+	double bus_wait_time = 0;
+	double bus_velocity = 0;
+};
+
 class TransportRouter {
 public:
-	TransportRouter(TransportCatalogue& catalogue, RoutingSettings routing_settings);
+	TransportRouter(const TransportCatalogue& catalogue, RoutingSettings routing_settings);
+	TransportRouter(const TransportCatalogue& catalogue, RoutingSettings routing_settings, TransportRouterData data);
 
 	std::optional<RouteGraphInfo> GetRouteGraphInfo(Stop* from, Stop* to) const;
+	// Routes from one stop to many, sharing a single shortest path tree where the engine allows it
+	std::vector<std::optional<RouteGraphInfo>> GetRouteGraphInfos(const Stop* from, const std::vector<const Stop*>& destinations) const;
+	// Fastest route with at most max_transfers changes between buses
+	std::optional<RouteGraphInfo> GetLimitedRouteGraphInfo(const Stop* from, const Stop* to, size_t max_transfers) const;
+	// Up to count routes ranked by time, on the graph for every engine. The RAPTOR engine builds
+	// the graph on the first such request, with bus_wait_time at every boarding.
+	std::vector<RouteGraphInfo> GetAlternativeRouteGraphInfos(const Stop* from, const Stop* to, size_t count) const;
+	RouteMatrix GetRouteMatrix(const std::vector<const Stop*>& origins, const std::vector<const Stop*>& destinations) const;
+	// Stop::id and arrival time of every stop reachable from `from` within max_time
+	std::vector<std::pair<size_t, double>> GetIsochrone(const Stop* from, double max_time) const;
+
+	const StopToRoute& GetStopToRoute() const;
+	const EdgeIdToEdge& GetEdgeIdToEdge() const;
+	const DirectedWeightedGraph<double>& GetGraph() const;
+	const Router<double>* GetRouter() const;
+	const Router<double, float>* GetCompactRouter() const;
+	const Router<uint32_t>* GetIntegerRouter() const;
+	const ContractionHierarchy<double>* GetContractionHierarchy() const;
+	const std::vector<size_t>& GetStrongComponents() const;
+	const std::vector<size_t>& GetWeakComponents() const;
+	// Empty when the cache is disabled
+	std::optional<cache::CacheStats> GetRouteCacheStats() const;
+
+	void PrintStats(std::ostream& output) const;
 
 private:
-	const std::variant<StopEdge, BusEdge>& GetEdgeAt(EdgeId id) const;
-	std::deque<Stop*> GetStopsPointers(TransportCatalogue& catalogue) const;
-	std::deque<Bus*> GetBusesPointers(TransportCatalogue& catalogue) const;
-	std::optional<WaitRange> GetRouteAtStop(Stop* stop) const;
+	using BusEdges = std::vector<std::pair<Edge<double>, BusEdge>>;
+	// Answers by origin and destination, not-found ones included
+	using RouteCache = cache::LruCache<std::pair<const Stop*, const Stop*>, std::optional<RouteGraphInfo>, DistanceHasher>;
 
-	void AddEdgeToStops();
-	void AddEdgeToBuses(TransportCatalogue& catalogue);
+	void InitializeRouter(const TransportCatalogue& catalogue, TransportRouterData& data);
+	void InitializeAllPairsRouter(TransportRouterData& data);
+	void InitializeGeoHeuristic(const TransportCatalogue& catalogue);
+	double ComputeGeoHeuristic(VertexId from, VertexId to) const;
+
+	const std::variant<StopEdge, BusEdge>& GetEdgeAt(EdgeId id) const;
+	std::deque<Stop*> GetStopsPointers(const TransportCatalogue& catalogue) const;
+	std::deque<Bus*> GetBusesPointers(const TransportCatalogue& catalogue) const;
+	std::optional<WaitRange> GetRouteAtStop(const Stop* stop) const;
+	std::optional<RouteInfo<double>> BuildRoute(VertexId from, VertexId to) const;
+	std::optional<double> GetRouteWeight(VertexId from, VertexId to) const;
+	// Copy of the graph in fixed point with the same edge ids. False when route weights could
+	// overflow uint32_t, the double-precision engines are used instead.
+	bool InitializeIntegerGraph();
+	// Minutes of the route summed over the edges of the original graph, so that answers do not
+	// depend on rounding
+	std::optional<RouteInfo<double>> ToMinutes(std::optional<RouteInfo<uint32_t>> route_info) const;
+	// False only when no route can exist, decided from the components without a search;
+	// a stop missing from the catalogue never reaches nor is reached
+	bool MayReach(const Stop* from, const Stop* to) const;
+	void InitializeComponents(TransportRouterData& data);
+	std::optional<RouteGraphInfo> MakeRouteGraphInfo(const std::optional<RouteInfo<double>>& route_info) const;
+
+	void AddEdgeToStops(const std::deque<Stop*>& stops);
+	void FreezeGraph();
+	void AddEdgeToBuses(const TransportCatalogue& catalogue);
 
 	Edge<double> CreateRouteFromStops(Stop* start, Stop* end, const double distance) const;
+	// Ride times divide by the velocity, a base or an override without a positive one is rejected
+	void CheckRoutingSettings() const;
+	double ComputeRideTime(double distance) const;
+	void UpdateEdgeWeights();
+
+	void PruneDominatedEdges(BusEdges& bus_edges) const;
 
 	template <typename Iterator>
-	void MakeEdgesFromBuses(Iterator first, Iterator last, const Bus* bus, const TransportCatalogue& catalogue);
+	void MakeEdgesFromBuses(Iterator first, Iterator last, const Bus* bus, const TransportCatalogue& catalogue, BusEdges& bus_edges) const;
 
 private:
-	std::unordered_map<Stop*, WaitRange> stop_to_route_;
-	std::unordered_map<EdgeId, std::variant<StopEdge, BusEdge>> edge_id_to_edge_;
+	StopToRoute stop_to_route_;
+	EdgeIdToEdge edge_id_to_edge_;
 
 	std::unique_ptr<DirectedWeightedGraph<double>> graph_;
 	std::unique_ptr<Router<double>> router_;
+	std::unique_ptr<Router<double, float>> compact_router_;
+	std::unique_ptr<DijkstraRouter<double>> dijkstra_router_;
+	std::unique_ptr<ContractionHierarchy<double>> contraction_hierarchy_;
+	std::unique_ptr<RaptorRouter> raptor_router_;
+	// The RAPTOR engine keeps no graph, a Dijkstra router over one is built for alternatives only
+	const TransportCatalogue* catalogue_ = nullptr;
+	mutable std::once_flag graph_router_built_;
+	mutable std::unique_ptr<TransportRouter> graph_router_;
+
+	static constexpr double FIXED_POINT_UNITS_PER_MINUTE = 600.0;
+	std::unique_ptr<DirectedWeightedGraph<uint32_t>> integer_graph_;
+	std::unique_ptr<Router<uint32_t>> integer_router_;
+	std::unique_ptr<DijkstraRouter<uint32_t>> integer_dijkstra_router_;
+
+	// A* heuristic: travel time along the great circle at bus velocity, scaled down so that it
+	// stays a lower bound for every edge of the base (0 turns A* into plain Dijkstra)
+	std::vector<geo::Coordinates> vertex_coordinates_;
+	double geo_heuristic_scale_ = 0.0;
+
+	std::vector<size_t> strong_components_;
+	std::vector<size_t> weak_components_;
+
+	// Stop name of every vertex, for the wait items of the single-vertex graph
+	std::vector<std::string_view> boarding_stop_names_;
+
+	std::unique_ptr<RouteCache> route_cache_;
+
+	// Bus edges before and after pruning, known only when the graph is built from the catalogue
+	std::optional<std::pair<size_t, size_t>> bus_edge_counts_;
+	bool weights_updated_ = false;
 
 	RoutingSettings routing_settings_;
 };
 
 template <typename Iterator>
-void TransportRouter::MakeEdgesFromBuses(Iterator first, Iterator last, const Bus* bus, const TransportCatalogue& catalogue) {
+void TransportRouter::MakeEdgesFromBuses(Iterator first, Iterator last, const Bus* bus, const TransportCatalogue& catalogue, BusEdges& bus_edges) const {
 	for (auto it = first; it != last; ++it) {
 		size_t dist = 0;
 		size_t span = 0;
@@ -57,9 +180,13 @@ void TransportRouter::MakeEdgesFromBuses(Iterator first, Iterator last, const Bu
 			dist += catalogue.GetDistanceBetweenStops(*prev(it_next), *it_next);
 			++span;
 
-			EdgeId id = graph_->AddEdge(CreateRouteFromStops(*it, *it_next, dist));
+			Edge<double> edge = CreateRouteFromStops(*it, *it_next, dist);
+			const double ride_time = edge.weight;
+			if (routing_settings_.graph_model == GraphModel::SINGLE_VERTEX) {
+				edge.weight += routing_settings_.bus_wait_time;
+			}
 
-			edge_id_to_edge_[id] = BusEdge{ bus->name, span, graph_->GetEdge(id).weight };
+			bus_edges.emplace_back(edge, BusEdge{ bus->name, span, ride_time, dist });
 		}
 	}
 }